@@ -25,21 +25,45 @@
 
 #include "deftypes.h"
 #include "tock.h"
+#include <QtGlobal>
+#if defined(TOCK_MONOTONIC_COARSE) && defined(Q_OS_LINUX)
+#include <time.h>
+#else
 #include <QElapsedTimer>
 
 static QElapsedTimer timer;
+#endif
+
+// The time cached by the outermost TockCacheScope of each thread
+static thread_local int tockCacheDepth = 0;
+static thread_local uint4 tockCache = 0;
+
+static uint4 readClock()
+{
+#if defined(TOCK_MONOTONIC_COARSE) && defined(Q_OS_LINUX)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint4)ts.tv_sec * 1000 + (uint4)(ts.tv_nsec / 1000000);
+#else
+    return (uint4)timer.elapsed();
+#endif
+}
 
 //Initializes the tock layer.  Only needs to be called once per application
 bool Tock_StartLib()
 {
+#if !(defined(TOCK_MONOTONIC_COARSE) && defined(Q_OS_LINUX))
     timer.start();
+#endif
     return true;
 }
 
 //Gets a tock representing the current time
 tock Tock_GetTock()
 {
-    return tock(timer.elapsed());
+    if(tockCacheDepth > 0)
+        return tock(tockCache);
+    return tock(readClock());
 }
 
 //Shuts down the tock layer.
@@ -47,3 +71,14 @@ void Tock_StopLib()
 {
 
 }
+
+TockCacheScope::TockCacheScope()
+{
+    if(tockCacheDepth++ == 0)
+        tockCache = readClock();
+}
+
+TockCacheScope::~TockCacheScope()
+{
+    --tockCacheDepth;
+}
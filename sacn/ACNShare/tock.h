@@ -34,6 +34,12 @@
   A ttimer is a simple abstraction for typical timer usage, which is
   setting a number of milliseconds to time out, and then telling whether
   or not the ttimer has expired.
+
+  While a TockCacheScope exists on a thread, Tock_GetTock() on that thread
+  returns the time read when the outermost scope was created, so a batch of
+  timer checks costs one clock read.  Defining TOCK_MONOTONIC_COARSE reads
+  CLOCK_MONOTONIC_COARSE on Linux, which is cheaper but only as fine as the
+  kernel tick (typically 1-4ms).
 */
 
 #ifndef _TOCK_H_
@@ -58,6 +64,18 @@ bool Tock_StartLib();
 tock Tock_GetTock();   //Gets a tock representing the current time
 void Tock_StopLib();   //Shuts down the tock layer.
 
+//Caches the current tock for this thread while it exists, nested scopes
+//keep the time of the outermost one
+class TockCacheScope
+{
+public:
+	TockCacheScope();
+	~TockCacheScope();
+private:
+	TockCacheScope(const TockCacheScope&);
+	TockCacheScope& operator=(const TockCacheScope&);
+};
+
 //This is the actual tock 
 class tock
 {
@@ -99,6 +117,7 @@ public:
 	void Reset();	//Resets the timer, using the current timeout interval
 	bool Expired();  //Returns true if the timer has expired.
 					 //Call Reset() to use this timer again for a new interval.
+	int4 Remaining(); //Returns the number of ms until Expired() will return true, 0 if it already does
 protected:
 	int4 interval;
 	tock tockout;
@@ -115,6 +134,7 @@ inline void ttimer::SetInterval(int4 ms) {interval = ms; Reset();}
 inline int4 ttimer::GetInterval() {return interval;}
 inline void ttimer::Reset() {tockout.Setms(Tock_GetTock().Getms() + interval);}
 inline bool ttimer::Expired() {return Tock_GetTock() > tockout;}
+inline int4 ttimer::Remaining() {int4 r = (int4)(tockout - Tock_GetTock()) + 1; return r > 0 ? r : 0;}
 
 /*tock implementation*/
 inline tock::tock():v(0) {}
@@ -0,0 +1,69 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNADDRESSMASK_H
+#define SACNADDRESSMASK_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+#include <string.h>
+
+/**
+ * @brief The sACNAddressMask struct holds one bit for each of the 512 addresses of a universe,
+ * address n is bit n % 64 of bits[n / 64]
+ */
+struct sACNAddressMask
+{
+    enum { Words = 8 };
+    quint64 bits[Words];
+
+    sACNAddressMask() { clear(); }
+
+    void clear() { memset(bits, 0, sizeof(bits)); }
+    void setAll() { memset(bits, 0xff, sizeof(bits)); }
+    void set(int address) { bits[address >> 6] |= Q_UINT64_C(1) << (address & 63); }
+    void reset(int address) { bits[address >> 6] &= ~(Q_UINT64_C(1) << (address & 63)); }
+    bool test(int address) const { return (bits[address >> 6] >> (address & 63)) & 1; }
+    bool any() const {
+        quint64 all = 0;
+        for(int i = 0; i < Words; i++)
+            all |= bits[i];
+        return all != 0;
+    }
+
+    /**
+     * @brief next finds the next set address, iterate with
+     * for(int a = mask.next(0); a < 512; a = mask.next(a + 1))
+     * @return the first set address from address on, 512 if there is none
+     */
+    int next(int address) const {
+        int word = address >> 6;
+        if(word >= Words)
+            return 512;
+        quint64 remaining = bits[word] & (~Q_UINT64_C(0) << (address & 63));
+        while(!remaining)
+        {
+            if(++word == Words)
+                return 512;
+            remaining = bits[word];
+        }
+        return (word << 6) + qCountTrailingZeroBits(remaining);
+    }
+
+    sACNAddressMask &operator|=(const sACNAddressMask &other) {
+        for(int i = 0; i < Words; i++)
+            bits[i] |= other.bits[i];
+        return *this;
+    }
+};
+
+#endif // SACNADDRESSMASK_H
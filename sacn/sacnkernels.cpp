@@ -0,0 +1,274 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnkernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define KERNEL_WIDTH 32
+#define KERNEL_SIMD
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KERNEL_WIDTH 16
+#define KERNEL_SIMD
+#else
+#define KERNEL_WIDTH 8
+#endif
+
+#if KERNEL_WIDTH == 32
+typedef __m256i vec;
+static inline vec vload(const uint1 *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+static inline void vstore(uint1 *p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+static inline vec vset(uint1 v) { return _mm256_set1_epi8(char(v)); }
+static inline vec vmax(vec a, vec b) { return _mm256_max_epu8(a, b); }
+static inline vec veq(vec a, vec b) { return _mm256_cmpeq_epi8(a, b); }
+static inline vec vand(vec a, vec b) { return _mm256_and_si256(a, b); }
+static inline vec vandnot(vec a, vec b) { return _mm256_andnot_si256(a, b); }
+static inline vec vor(vec a, vec b) { return _mm256_or_si256(a, b); }
+static inline quint32 vmovemask(vec v) { return quint32(_mm256_movemask_epi8(v)); }
+#elif KERNEL_WIDTH == 16
+typedef __m128i vec;
+static inline vec vload(const uint1 *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+static inline void vstore(uint1 *p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+static inline vec vset(uint1 v) { return _mm_set1_epi8(char(v)); }
+static inline vec vmax(vec a, vec b) { return _mm_max_epu8(a, b); }
+static inline vec veq(vec a, vec b) { return _mm_cmpeq_epi8(a, b); }
+static inline vec vand(vec a, vec b) { return _mm_and_si128(a, b); }
+static inline vec vandnot(vec a, vec b) { return _mm_andnot_si128(a, b); }
+static inline vec vor(vec a, vec b) { return _mm_or_si128(a, b); }
+static inline quint32 vmovemask(vec v) { return quint32(_mm_movemask_epi8(v)) & 0xffff; }
+#endif
+
+// Compares KERNEL_WIDTH addresses, stores the new ones and returns a bit per changed address
+static inline quint64 updateChunk(uint1 *frame, const uint1 *data)
+{
+#ifdef KERNEL_SIMD
+    vec next = vload(data);
+    quint32 diff = ~vmovemask(veq(next, vload(frame)));
+#if KERNEL_WIDTH < 32
+    diff &= (1u << KERNEL_WIDTH) - 1;
+#endif
+    if(diff)
+        vstore(frame, next);
+    return diff;
+#else
+    quint64 diff = 0;
+    for(int i = 0; i < KERNEL_WIDTH; i++)
+    {
+        if(frame[i] != data[i])
+        {
+            diff |= Q_UINT64_C(1) << i;
+            frame[i] = data[i];
+        }
+    }
+    return diff;
+#endif
+}
+
+bool sACNUpdateFrame(uint1 *frame, const uint1 *data, int count, sACNAddressMask &changed)
+{
+    if(count > 512)
+        count = 512;
+    if(count < 0)
+        count = 0;
+
+    quint64 any = 0;
+    for(int offset = 0; offset < 512; offset += KERNEL_WIDTH)
+    {
+        quint64 diff;
+        if(offset + KERNEL_WIDTH <= count)
+        {
+            diff = updateChunk(frame + offset, data + offset);
+        }
+        else
+        {
+            // Short frame, pad the rest with zeros
+            uint1 padded[KERNEL_WIDTH];
+            memset(padded, 0, sizeof(padded));
+            if(count > offset)
+                memcpy(padded, data + offset, count - offset);
+            diff = updateChunk(frame + offset, padded);
+        }
+        changed.bits[offset >> 6] |= diff << (offset & 63);
+        any |= diff;
+    }
+    return any != 0;
+}
+
+#ifdef KERNEL_SIMD
+// All ones where the row sends the address. Kept apart from the priority, which uses all 256
+// values, so that priorities above 200 compare like they do in the plain C++ loop
+static inline vec sendingMask(vec priority, bool perChannel)
+{
+    if(perChannel)
+        return vandnot(veq(priority, vset(0)), vset(0xff));
+    return vset(0xff);
+}
+
+static inline vec select(vec mask, vec a, vec b)
+{
+    return vor(vand(mask, a), vandnot(mask, b));
+}
+
+template<int Policy>
+static void mergeChunk(const sACNMergeInput &input, int offset, sACNMergeOutput &output)
+{
+    const vec zero = vset(0);
+    const vec ones = vset(0xff);
+
+    // Highest priority first..
+    vec highest = zero;
+    for(int row = 0; row < input.rows; row++)
+    {
+        vec priority = vload(input.priorities[row] + offset);
+        highest = vmax(highest, vand(sendingMask(priority, input.perChannel[row]), priority));
+    }
+
+    // ..then pick one of the sources with that priority
+    vec best = zero;
+    vec winner = vset(SACN_NO_WINNER);
+    vec found = zero;
+    vec lastChanged = zero, latestLevel = zero, latestWinner = zero, latestFound = zero;
+    if(Policy == sACNMergeLTP)
+        lastChanged = vload(input.lastChanged + offset);
+    for(int row = 0; row < input.rows; row++)
+    {
+        vec priority = vload(input.priorities[row] + offset);
+        vec candidate = vand(veq(priority, highest), sendingMask(priority, input.perChannel[row]));
+        vec level = vload(input.levels[row] + offset);
+        vec take;
+        if(Policy == sACNMergeMostRecent)
+        {
+            // Rows are sorted by recency, the first candidate wins
+            take = vandnot(found, candidate);
+        }
+        else
+        {
+            // The highest level wins, the first one on a tie
+            vec higher = vandnot(veq(vmax(level, best), best), ones);
+            take = vand(candidate, vor(vandnot(found, ones), higher));
+        }
+        best = select(take, level, best);
+        winner = select(take, vset(uint1(row)), winner);
+        found = vor(found, candidate);
+
+        if(Policy == sACNMergeLTP)
+        {
+            vec latest = vand(candidate, veq(lastChanged, vset(input.ids[row])));
+            latestLevel = select(latest, level, latestLevel);
+            latestWinner = select(latest, vset(uint1(row)), latestWinner);
+            latestFound = vor(latestFound, latest);
+        }
+    }
+    // 0 where nobody sends, like the plain C++ loop
+    vec priority = highest;
+
+    if(Policy == sACNMergeLTP)
+    {
+        // Where the source that changed last is a candidate, it wins
+        best = select(latestFound, latestLevel, best);
+        winner = select(latestFound, latestWinner, winner);
+    }
+    else if(Policy == sACNMergeForcedSource)
+    {
+        // Row 0 wins wherever it sends
+        vec forcedPriority = vload(input.priorities[0] + offset);
+        vec forced = sendingMask(forcedPriority, input.perChannel[0]);
+        best = select(forced, vload(input.levels[0] + offset), best);
+        winner = select(forced, vset(0), winner);
+        priority = select(forced, forcedPriority, priority);
+    }
+
+    vstore(output.levels + offset, best);
+    vstore(output.priorities + offset, priority);
+    vstore(output.winners + offset, winner);
+}
+#else
+template<int Policy>
+static void mergeChunk(const sACNMergeInput &input, int offset, sACNMergeOutput &output)
+{
+    for(int address = offset; address < offset + KERNEL_WIDTH; address++)
+    {
+        int highest = 0;
+        int winner = SACN_NO_WINNER;
+        int latest = SACN_NO_WINNER;
+        uint1 best = 0;
+        for(int row = 0; row < input.rows; row++)
+        {
+            uint1 priority = input.priorities[row][address];
+            if(priority == 0 && input.perChannel[row])
+                continue;
+            int effective = priority + 1;
+            if(Policy == sACNMergeForcedSource && row == 0)
+            {
+                // Row 0 wins wherever it sends, the other rows need not be looked at
+                highest = effective;
+                best = input.levels[0][address];
+                winner = 0;
+                break;
+            }
+            bool take = effective > highest;
+            if(Policy != sACNMergeMostRecent)
+                take |= (effective == highest && input.levels[row][address] > best);
+            if(take)
+            {
+                if(effective > highest)
+                    latest = SACN_NO_WINNER;
+                highest = effective;
+                best = input.levels[row][address];
+                winner = row;
+            }
+            if(Policy == sACNMergeLTP && effective == highest && input.lastChanged[address] == input.ids[row])
+                latest = row;
+        }
+        if(Policy == sACNMergeLTP && latest != SACN_NO_WINNER)
+        {
+            best = input.levels[latest][address];
+            winner = latest;
+        }
+        output.levels[address] = best;
+        output.priorities[address] = highest ? input.priorities[winner][address] : 0;
+        output.winners[address] = uint1(winner);
+    }
+}
+#endif
+
+template<int Policy>
+static void mergeAddresses(const sACNMergeInput &input, const sACNAddressMask &addresses, sACNMergeOutput &output)
+{
+    for(int word = 0; word < sACNAddressMask::Words; word++)
+    {
+        if(!addresses.bits[word])
+            continue;
+        for(int offset = word * 64; offset < (word + 1) * 64; offset += KERNEL_WIDTH)
+            mergeChunk<Policy>(input, offset, output);
+    }
+}
+
+void sACNMerge(sACNMergePolicy policy, const sACNMergeInput &input, const sACNAddressMask &addresses, sACNMergeOutput &output)
+{
+    switch(policy)
+    {
+    case sACNMergeHTP:
+        mergeAddresses<sACNMergeHTP>(input, addresses, output);
+        break;
+    case sACNMergeLTP:
+        mergeAddresses<sACNMergeLTP>(input, addresses, output);
+        break;
+    case sACNMergeMostRecent:
+        mergeAddresses<sACNMergeMostRecent>(input, addresses, output);
+        break;
+    case sACNMergeForcedSource:
+        mergeAddresses<sACNMergeForcedSource>(input, addresses, output);
+        break;
+    }
+}
@@ -0,0 +1,87 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNKERNELS_H
+#define SACNKERNELS_H
+
+#include "ACNShare/deftypes.h"
+#include "sacnaddressmask.h"
+
+/*
+ * Inner loops of the receive path. They use AVX2 or SSE2 when the compiler
+ * targets it, and plain C++ otherwise.
+ */
+
+/**
+ * @brief sACNUpdateFrame stores a received frame of 512 addresses in place and marks the
+ * addresses which changed
+ * @param frame the current frame of the source, overwritten with the new one
+ * @param data the received slots, addresses from count up to 512 are taken as 0
+ * @param count the number of received slots, clamped to 512
+ * @param changed the bits of changed addresses are set, others are left as they are
+ * @return true if any address changed
+ */
+bool sACNUpdateFrame(uint1 *frame, const uint1 *data, int count, sACNAddressMask &changed);
+
+// The winner of an address nobody is sending
+#define SACN_NO_WINNER 0xff
+
+// The largest number of sources merged at once
+#define SACN_MERGE_MAX_ROWS 64
+
+/**
+ * @brief The sACNMergePolicy enum selects how sACNMerge() picks the winner of an address among
+ * the sources sending it with the highest priority
+ */
+enum sACNMergePolicy
+{
+    sACNMergeHTP,          // Highest level, as E1.31 receivers do
+    sACNMergeLTP,          // The source which changed the address last, highest level until one does
+    sACNMergeMostRecent,   // The first row, so the caller sorts the rows by the time they were received
+    sACNMergeForcedSource  // Row 0 wins wherever it sends, regardless of priority, HTP elsewhere
+};
+
+/**
+ * @brief The sACNMergeInput struct holds the frames of the sources to merge, one row per source
+ */
+struct sACNMergeInput
+{
+    int rows;
+    // The level and the (per-channel) priority frame of each source, 512 addresses each
+    const uint1 *levels[SACN_MERGE_MAX_ROWS];
+    const uint1 *priorities[SACN_MERGE_MAX_ROWS];
+    // Whether each source is sending per-channel priority, then a priority of 0 means not sending
+    bool perChannel[SACN_MERGE_MAX_ROWS];
+    // sACNMergeLTP only: an id of each row, and the id of the row which changed each address last
+    uint1 ids[SACN_MERGE_MAX_ROWS];
+    const uint1 *lastChanged;
+};
+
+/**
+ * @brief The sACNMergeOutput struct receives the result of sACNMerge()
+ */
+struct sACNMergeOutput
+{
+    uint1 levels[512];
+    uint1 priorities[512];
+    // The row of the winning source of each address, SACN_NO_WINNER if none
+    uint1 winners[512];
+};
+
+/**
+ * @brief sACNMerge merges the frames of several sources, highest priority first, then as the
+ * policy says. Each policy is compiled into its own loop.
+ * @param addresses the addresses to merge, the results for others are undefined
+ */
+void sACNMerge(sACNMergePolicy policy, const sACNMergeInput &input, const sACNAddressMask &addresses, sACNMergeOutput &output);
+
+#endif // SACNKERNELS_H
@@ -0,0 +1,83 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnlevelssubscriber.h"
+
+#include "sacnlistener.h"
+
+sACNLevelsSubscriber::sACNLevelsSubscriber(QSharedPointer<sACNListener> listener, int maxRate, QObject *parent) : QObject(parent),
+    m_listener(listener),
+    m_maxRate(maxRate),
+    m_version(0),
+    m_posted(false)
+{
+    qRegisterMetaType<sACNAddressMask>("sACNAddressMask");
+    for(int i = 0; i < sACNAddressMask::Words; i++)
+        m_pending[i].store(0);
+
+    m_rateTimer = new QTimer(this);
+    m_rateTimer->setSingleShot(true);
+    connect(m_rateTimer, SIGNAL(timeout()), this, SLOT(deliver()));
+
+    m_listener->addSubscriber(this);
+}
+
+sACNLevelsSubscriber::~sACNLevelsSubscriber()
+{
+    // Once this returns the listener won't post to us any more
+    m_listener->removeSubscriber(this);
+}
+
+void sACNLevelsSubscriber::setMaxRate(int maxRate)
+{
+    m_maxRate = maxRate;
+}
+
+void sACNLevelsSubscriber::post(const sACNAddressMask &changed, quint64 version)
+{
+    for(int i = 0; i < sACNAddressMask::Words; i++)
+    {
+        if(changed.bits[i])
+            m_pending[i].fetch_or(changed.bits[i], std::memory_order_relaxed);
+    }
+    m_version.store(version, std::memory_order_release);
+
+    // Only one delivery is queued, later changes are added to it
+    if(!m_posted.exchange(true))
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void sACNLevelsSubscriber::deliver()
+{
+    if(m_maxRate > 0 && m_lastDelivery.isValid())
+    {
+        qint64 wait = 1000 / m_maxRate - m_lastDelivery.elapsed();
+        if(wait > 0)
+        {
+            // Too early, keep collecting changes
+            if(!m_rateTimer->isActive())
+                m_rateTimer->start(int(wait));
+            return;
+        }
+    }
+
+    // Clear the flag first, changes posted from now on will queue another delivery
+    m_posted.store(false);
+    sACNAddressMask changed;
+    for(int i = 0; i < sACNAddressMask::Words; i++)
+        changed.bits[i] = m_pending[i].exchange(0);
+    if(!changed.any())
+        return;
+
+    m_lastDelivery.start();
+    emit levelsChanged(changed, m_version.load(std::memory_order_acquire));
+}
@@ -0,0 +1,78 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNLEVELSSUBSCRIBER_H
+#define SACNLEVELSSUBSCRIBER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QMetaType>
+#include <atomic>
+#include "sacnaddressmask.h"
+
+class sACNListener;
+
+/**
+ * @brief The sACNLevelsSubscriber class tells one consumer which addresses of a universe changed.
+ * Create it on the thread of the consumer. Changes of all merges since the last notification are
+ * combined, so a consumer which is slower than the merges gets one notification covering all of
+ * them instead of a backlog of events.
+ */
+class sACNLevelsSubscriber : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param listener the listener of the universe, kept alive by the subscriber
+     * @param maxRate the highest number of notifications per second, 0 for no limit
+     */
+    sACNLevelsSubscriber(QSharedPointer<sACNListener> listener, int maxRate = 0, QObject *parent = nullptr);
+    virtual ~sACNLevelsSubscriber();
+
+    QSharedPointer<sACNListener> listener() { return m_listener; }
+
+    void setMaxRate(int maxRate);
+    int maxRate() { return m_maxRate; }
+
+    /**
+     * @brief post adds the changes of a merge, called by the listener on its own thread
+     */
+    void post(const sACNAddressMask &changed, quint64 version);
+
+signals:
+    /**
+     * @brief levelsChanged is emitted on the thread of the subscriber
+     * @param changed the addresses whose level or winning source changed since the last notification
+     * @param version the version of the merged frame, see sACNListener::mergedFrame()
+     */
+    void levelsChanged(const sACNAddressMask &changed, quint64 version);
+
+private slots:
+    void deliver();
+
+private:
+    QSharedPointer<sACNListener> m_listener;
+    int m_maxRate;
+    // Changes not delivered yet, written by the listener thread
+    std::atomic<quint64> m_pending[sACNAddressMask::Words];
+    std::atomic<quint64> m_version;
+    // A delivery is posted or waiting for the rate limit
+    std::atomic<bool> m_posted;
+    QElapsedTimer m_lastDelivery;
+    QTimer *m_rateTimer;
+};
+
+Q_DECLARE_METATYPE(sACNAddressMask)
+
+#endif // SACNLEVELSSUBSCRIBER_H
@@ -15,13 +15,16 @@
 
 #include "sacnlistener.h"
 
+#include "sacnlevelssubscriber.h"
+#include "sacnlog.h"
 #include "streamcommon.h"
 #include "ACNShare/deftypes.h"
 #include "ACNShare/defpack.h"
 #include "ACNShare/CID.h"
 #include <QDebug>
+#include <algorithm>
 #include <QThread>
-#include <QPoint>
+#include <QMetaMethod>
 #include <QSharedPointer>
 #include <QWeakPointer>
 
@@ -36,28 +39,73 @@
 //The time during which to sample
 #define SAMPLE_TIME 1500
 
+//The number of packets other threads can queue for a listener
+#define PACKET_QUEUE_SIZE 64
+
+//The default amount of ms a source has to be offline before its slot is reclaimed
+#define DEFAULT_RECLAIM_TIME 300000
+
+//The number of samples kept for each monitored address
+#define SAMPLE_RING_SIZE 4096
+
 sACNListener::sACNListener(int universe, QObject *parent) : QObject(parent),
+    m_packetQueue(PACKET_QUEUE_SIZE),
+    m_packetQueueNotified(false),
+    m_sourceReclaimTime(DEFAULT_RECLAIM_TIME),
     m_universe(universe),
     m_ssHLL(1000),
     m_isSampling(true),
+    m_expiryWheel(SACN_MAX_SOURCES, Tock_GetTock().Getms()),
+    m_mergeScheduled(false),
+    m_mergePolicy(sACNMergeHTP),
     m_mergesPerSecond(0)
 {
+    m_startTime = sACNPacket::currentTime();
     m_merged_levels.reserve(512);
     for(int i=0; i<512; i++)
         m_merged_levels << sACNMergedAddress();
+    m_sources.reserve(SACN_MAX_SOURCES);
+    m_freeSlots.reserve(SACN_MAX_SOURCES);
+    m_deleteRemovedSources.store(false);
+    memset(m_lastChanged, SACN_NO_WINNER, sizeof(m_lastChanged));
+    for(int i=0; i<512; i++)
+        m_sampleRings[i].store(nullptr);
+    for(int i=0; i<sACNAddressMask::Words; i++)
+        m_monitoredAddresses[i].store(0);
+    // Source signals, releaseSource() and setMergePolicy() cross threads
+    qRegisterMetaType<sACNSource *>("sACNSource*");
+    qRegisterMetaType<CID>("CID");
+
+    // The timers are children, so they move to the receive thread with the listener.
+    // Packets can be processed before startReception() has run.
+    m_initalSampleTimer = new QTimer(this);
+    m_initalSampleTimer->setSingleShot(true);
+    m_initalSampleTimer->setInterval(SAMPLE_TIME);
+    connect(m_initalSampleTimer, SIGNAL(timeout()), this, SLOT(sampleExpiration()), Qt::DirectConnection);
+
+    // Merge is performed after each batch of packets, see flushMerge(),
+    // sources are checked when their deadline in m_expiryWheel comes up
+    m_mergesPerSecondTimer.start();
+    m_expirationTimer = new QTimer(this);
+    m_expirationTimer->setSingleShot(true);
+    m_expirationTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_expirationTimer, SIGNAL(timeout()), this, SLOT(checkSourceExpiration()), Qt::DirectConnection);
 }
 
 sACNListener::~sACNListener()
 {
-    m_initalSampleTimer->deleteLater();
-    m_mergeTimer->deleteLater();
     qDeleteAll(m_sockets);
-    qDebug() << "sACNListener" << QThread::currentThreadId() << ": stopping";
+    qDeleteAll(m_sources);
+    for(const RetiredSource &retired : m_retiredSources)
+        delete retired.source;
+    for(int i=0; i<512; i++)
+        delete m_sampleRings[i].load();
+    qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ": stopping";
 }
 
 void sACNListener::startReception()
 {
-    qDebug() << "sACNListener" << QThread::currentThreadId() << ": Starting universe" << m_universe;
+    qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ": Starting universe" << m_universe;
 
     // Clear the levels array
     memset(&m_last_levels, -1, 512);
@@ -71,64 +119,221 @@ void sACNListener::startReception()
        m_sockets.pop_back();
     }
 
-    // Listen unicast
-    m_sockets.push_back(new sACNRxSocket());
-    if (m_sockets.back()->bindUnicast()) {
-        connect(m_sockets.back(), SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()), Qt::DirectConnection);
-    } else {
-       // Failed to bind
-       m_sockets.pop_back();
-    }
+    // Unicast is received by the shared socket of sACNManager and routed to us
 
     // Start intial sampling
-    m_initalSampleTimer = new QTimer(this);
-    m_initalSampleTimer->setSingleShot(true);
-    m_initalSampleTimer->setInterval(SAMPLE_TIME);
-    connect(m_initalSampleTimer, SIGNAL(timeout()), this, SLOT(sampleExpiration()), Qt::DirectConnection);
     m_initalSampleTimer->start();
+}
 
-    // Merge is performed whenever the thread has time
-    m_elapsedTime.start();
-    m_mergesPerSecondTimer.start();
-    m_mergeTimer = new QTimer(this);
-    m_mergeTimer->setInterval(1);
-    connect(m_mergeTimer, SIGNAL(timeout()), this, SLOT(performMerge()), Qt::DirectConnection);
-    connect(m_mergeTimer, SIGNAL(timeout()), this, SLOT(checkSourceExpiration()), Qt::DirectConnection);
-    m_mergeTimer->start();
+void sACNListener::scheduleMerge()
+{
+    // Merged by flushMerge() once the current batch of datagrams has been processed,
+    // so a whole batch is merged at once without posting an event for it
+    m_mergeScheduled = true;
+}
+
+void sACNListener::flushMerge()
+{
+    if(m_mergeScheduled)
+        performMerge();
+}
+
+void sACNListener::scheduleExpiration(sACNSource *ps)
+{
+    int ms = nextExpiration(ps);
+    if(ms < 0)
+    {
+        m_expiryWheel.cancel(ps->slot);
+        return;
+    }
+    quint32 now = Tock_GetTock().Getms();
+    // Later deadlines leave the wheel alone, so most packets stop here
+    if(m_expiryWheel.schedule(ps->slot, now + ms))
+        armExpirationTimer(now);
+}
+
+void sACNListener::armExpirationTimer(quint32 now)
+{
+    int ms = m_expiryWheel.nextTick(now);
+    if(ms < 0)
+        return;
+    if(!m_expirationTimer->isActive() || m_expirationTimer->remainingTime() > ms)
+        m_expirationTimer->start(ms);
+}
+
+int sACNListener::nextExpiration(sACNSource *ps)
+{
+    switch(ps->slot_state)
+    {
+    case sACNSource::SlotFree:
+    case sACNSource::SlotRetired:
+        return -1;
+    case sACNSource::SlotInUse:
+        break;
+    }
+    if(!ps->src_valid)
+        return ps->reclaim_wait.Remaining();
+    if(ps->doing_per_channel)
+        return ps->priority_wait.Remaining();
+    // Lost once both have run out
+    return qMax(ps->active.Remaining(), ps->priority_wait.Remaining());
 }
 
 
 void sACNListener::sampleExpiration()
 {
     m_isSampling = false;
-    qDebug() << "sACNListener" << QThread::currentThreadId() << ": Sampling has ended";
+    qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ": Sampling has ended";
 }
 
 void sACNListener::checkSourceExpiration()
 {
+    TockCacheScope tockCache;
     char cidstr [CID::CIDSTRINGBYTES];
-    for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
+    quint32 now = Tock_GetTock().Getms();
+    // Only the sources with a deadline that has come up
+    int expired[SACN_MAX_SOURCES];
+    int count = m_expiryWheel.advance(now, expired);
+    for(int i = 0; i < count; i++)
     {
-        if((*it)->src_valid)
+        sACNSource *ps = m_sources[expired[i]];
+        if(ps->slot_state != sACNSource::SlotInUse)
+        {
+            // Free slots wait for allocateSource()
+        }
+        else if(!ps->src_valid)
         {
-            if((*it)->active.Expired() && (*it)->priority_wait.Expired())
+            if(ps->reclaim_wait.Expired())
             {
-                (*it)->src_valid = false;
-                CID::CIDIntoString((*it)->src_cid, cidstr);
-                emit sourceLost(*it);
+                // Offline for long enough, forget it
+                CID::CIDIntoString(ps->src_cid, cidstr);
+                qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ": Removed source" << cidstr;
+                retireSource(ps);
+                ps = m_sources[expired[i]];
+            }
+        }
+        else
+        {
+            if(ps->active.Expired() && ps->priority_wait.Expired())
+            {
+                ps->setState(ps->state & ~sACNSourceStateMachine::Valid);
+                ps->reclaim_wait.SetInterval(m_sourceReclaimTime);
+                CID::CIDIntoString(ps->src_cid, cidstr);
+                emit sourceLost(ps);
                 m_mergeAll = true;
-                qDebug() << "Lost source " << cidstr;
+                qCDebug(sacnListenerLog) << "Lost source " << cidstr;
             }
-            else if ((*it)->doing_per_channel && (*it)->priority_wait.Expired())
+            else if (ps->doing_per_channel && ps->priority_wait.Expired())
             {
-                CID::CIDIntoString((*it)->src_cid, cidstr);
-                (*it)->doing_per_channel = false;
-                emit sourceChanged(*it);
+                CID::CIDIntoString(ps->src_cid, cidstr);
+                ps->setState(ps->state & ~sACNSourceStateMachine::PerChannel);
+                emit sourceChanged(ps);
                 m_mergeAll = true;
-                qDebug() << "sACNListener" << QThread::currentThreadId() << ": Source stopped sending per-channel priority" << cidstr;
+                qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ": Source stopped sending per-channel priority" << cidstr;
             }
         }
+        scheduleExpiration(ps);
+    }
+    armExpirationTimer(now);
+
+    if(m_mergeAll)
+        scheduleMerge();
+    flushMerge();
+}
+
+quint64 sACNListener::copyLevels(uint1 *levels) const
+{
+    Q_STATIC_ASSERT(offsetof(sACNMergedFrame, levels) == sizeof(quint64));
+    quint64 version;
+    // Version and levels are next to each other, so they are read in one go
+    uint1 buffer[sizeof(version) + sizeof(m_frame.levels)];
+    m_publishedFrame.readPart(buffer, offsetof(sACNMergedFrame, version), sizeof(buffer));
+    memcpy(&version, buffer, sizeof(version));
+    memcpy(levels, buffer + sizeof(version), sizeof(m_frame.levels));
+    return version;
+}
+
+QList<sACNSource *> sACNListener::otherSources(const sACNMergedAddress &address)
+{
+    QList<sACNSource *> result;
+    for(quint64 bits = address.otherSources; bits;)
+        result << m_sources[sACNMergedAddress::takeSlot(bits)];
+    return result;
+}
+
+void sACNListener::retireSource(sACNSource *ps)
+{
+    m_sourceTable.remove(ps->src_cid);
+    ps->slot_state = sACNSource::SlotRetired;
+
+    // The slot is free for a new source right away, with an object of its own, so that
+    // receivers which are slow to release the old one never hold up new sources
+    sACNSource *fresh = new sACNSource();
+    fresh->slot = ps->slot;
+    fresh->slot_state = sACNSource::SlotFree;
+    m_sources[ps->slot] = fresh;
+    m_freeSlots.push_back(ps->slot);
+
+    int receiverCount = receivers(SIGNAL(sourceRemoved(sACNSource*)));
+    emit sourceRemoved(ps);
+    if(receiverCount == 0 && m_deleteRemovedSources.load(std::memory_order_relaxed))
+    {
+        delete ps;
+        return;
     }
+    // Without receivers nobody releases it, so it stays until the listener is destroyed:
+    // pointers from the other source signals may still be held, or queued to other threads
+    RetiredSource retired;
+    retired.source = ps;
+    retired.pendingReleases = receiverCount;
+    m_retiredSources.push_back(retired);
+}
+
+void sACNListener::releaseSource(sACNSource *source)
+{
+    // The list of retired sources belongs to the listener thread
+    QMetaObject::invokeMethod(this, "sourceReleased", Qt::QueuedConnection, Q_ARG(sACNSource *, source));
+}
+
+void sACNListener::sourceReleased(sACNSource *source)
+{
+    // Sources are only deleted after their last release, so the pointer cannot belong to
+    // a newer one yet
+    for(auto it = m_retiredSources.begin(); it != m_retiredSources.end(); ++it)
+    {
+        if(it->source != source || it->pendingReleases == 0)
+            continue;
+        if(--it->pendingReleases == 0)
+        {
+            delete it->source;
+            m_retiredSources.erase(it);
+        }
+        return;
+    }
+    qCWarning(sacnListenerLog) << "sACNListener: releaseSource() called more often than sourceRemoved() had receivers";
+}
+
+sACNSource *sACNListener::allocateSource()
+{
+    sACNSource *ps;
+    if(!m_freeSlots.empty())
+    {
+        // Reuse the slot of a source that was reclaimed
+        ps = m_sources[m_freeSlots.back()];
+        m_freeSlots.pop_back();
+        ps->recycle();
+    }
+    else if(m_sources.size() < SACN_MAX_SOURCES)
+    {
+        ps = new sACNSource();
+        ps->slot = int(m_sources.size());
+        m_sources.push_back(ps);
+    }
+    else
+    {
+        return nullptr;
+    }
+    return ps;
 }
 
 void sACNListener::readPendingDatagrams()
@@ -143,33 +348,71 @@ void sACNListener::readPendingDatagrams()
     // Check all sockets
     foreach (sACNRxSocket* m_socket, m_sockets)
     {
-        while(m_socket->hasPendingDatagrams())
+        int count;
+        do
         {
-            QByteArray data;
-            data.resize(m_socket->pendingDatagramSize());
-            QHostAddress sender;
-            quint16 senderPort;
-
-            m_socket->readDatagram(data.data(), data.size(),
-                                    &sender, &senderPort);
-
-            processDatagram(
-                        data,
-                        m_socket->localAddress(),
-                        sender);
-        }
+            count = m_socket->readDatagramBatch();
+            // One clock read for the timers of the whole batch
+            TockCacheScope tockCache;
+            for (int i = 0; i < count; i++)
+            {
+                const sACNPacket &packet = m_socket->batchPacket(i);
+                if (packet.length >= 0)
+                    processPacket(packet);
+            }
+        } while (count == SACN_RX_BATCH_SIZE);
     }
+    flushMerge();
+}
+
+bool sACNListener::queuePacket(const sACNPacket &packet)
+{
+    if(!m_packetQueue.push(packet))
+        return false;
+
+    // Only one notification is posted until the queue has been drained
+    if(!m_packetQueueNotified.exchange(true))
+        QMetaObject::invokeMethod(this, "processQueuedPackets", Qt::QueuedConnection);
+    return true;
+}
+
+void sACNListener::processQueuedPackets()
+{
+    m_packetQueueNotified.store(false);
+    TockCacheScope tockCache;
+    while(const sACNPacket *packet = m_packetQueue.front())
+    {
+        processPacket(*packet);
+        m_packetQueue.pop();
+    }
+    flushMerge();
 }
 
 void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHostAddress sender)
 {
+    if(data.length() > SACN_PACKET_SIZE)
+        return; // Too big to be sACN
+
+    sACNPacket packet;
+    memcpy(packet.data, data.data(), data.length());
+    packet.length = data.length();
+    packet.sender = sender.toIPv4Address();
+    packet.multicast = receiver.isMulticast();
+    packet.timestamp = sACNPacket::currentTime();
+    processPacket(packet);
+    flushMerge();
+}
+
+void sACNListener::processPacket(const sACNPacket &packet)
+{
+    TockCacheScope tockCache;
     // Process packet
     CID source_cid;
     uint1 start_code;
     uint1 sequence;
     uint2 universe;
     uint2 slot_count;
-    uint1* pdata;
+    const uint1* pdata;
     char source_name [SOURCE_NAME_SIZE];
     uint1 priority;
     /*
@@ -179,33 +422,31 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
     uint2 reserved = 0;
     uint1 options = 0;
     bool preview = false;
-    uint1 *pbuf = reinterpret_cast<uint1*>(data.data());
+    const uint1 *pbuf = packet.data;
 
-    if(!ValidateStreamHeader(pbuf, data.length(), source_cid, source_name, priority,
+    if(!ValidateStreamHeader(pbuf, packet.length, source_cid, source_name, priority,
             start_code, reserved, sequence, options, universe, slot_count, pdata))
     {
         // Recieved a packet but not valid. Log and discard
-        qDebug() << "sACNListener" << QThread::currentThreadId() << ": Invalid Packet";
+        SACN_LOG_DROP(m_drops, sACNDropInvalid, "Invalid Packet");
         return;
     }
 
     // Unpacks a uint4 from a known big endian buffer
-    int root_vect = UpackB4((uint1*)pbuf + ROOT_VECTOR_ADDR);
+    int root_vect = UpackB4(pbuf + ROOT_VECTOR_ADDR);
 
     // Packet for the wrong universe on this socket?
     if(m_universe != universe)
     {
         // Was it unicast? Send to correct listner (if listening)
-        if (receiver.isMulticast())
+        if (packet.multicast)
         {
             // Log and discard
-            qDebug() << "sACNListener" << QThread::currentThreadId() << ": Wrong Universe and is multicast";
+            SACN_LOG_DROP(m_drops, sACNDropWrongUniverse, "Wrong Universe and is multicast");
             return;
         } else {
             // Unicast, send to releivent listener!
-            const QHash<int, QWeakPointer<sACNListener> > listenerList = sACNManager::getInstance()->getListenerList();
-            if (listenerList.contains(universe))
-                listenerList[universe].data()->processDatagram(data, receiver, sender);
+            sACNManager::getInstance()->routePacket(packet, universe);
             return;
         }
     }
@@ -215,169 +456,63 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
     bool showBlindData = false;
     if ((preview) && !showBlindData)
     {
-        qDebug() << "sACNListener" << QThread::currentThreadId() << ": Ignore preview";
+        SACN_LOG_DROP(m_drops, sACNDropPreview, "Ignore preview");
         return;
     }
 
-    sACNSource *ps = nullptr; // Pointer to the source
-    bool foundsource = false;
-    bool newsourcenotify = false;
-    bool validpacket = true;  //whether or not we will actually process the packet
+    typedef sACNSourceStateMachine SM;
+    quint8 input = SM::packetInput(start_code,
+            (root_vect == ROOT_VECTOR) && ((options & STREAM_TERMINATED_OPTION) == STREAM_TERMINATED_OPTION));
+    const SM::Timeouts timeouts = {WAIT_PRIORITY, WAIT_OFFLINE + m_ssHLL, m_ssHLL};
+    bool validpacket; //whether or not we will actually process the packet
+    bool newsourcenotify;
 
-    for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
+    sACNSource *ps = nullptr; // Pointer to the source
+    int slot = m_sourceTable.find(source_cid);
+    if(slot < 0)  //Add a new source to the list
     {
-        if((*it)->src_cid == source_cid)
+        ps = allocateSource();
+        if(!ps)
         {
-            foundsource = true;
-            ps = *it;
-
-            if(!ps->src_valid)
-            {
-                // This is a source which is coming back online, so we need to repeat the steps
-                // for initial source aquisition
-                ps->active.SetInterval(WAIT_OFFLINE + m_ssHLL);
-                ps->lastseq = sequence;
-                ps->src_cid = source_cid;
-                ps->src_valid = true;
-                ps->doing_dmx = (start_code == STARTCODE_DMX);
-                ps->doing_per_channel = ps->waited_for_dd = false;
-                newsourcenotify = false;
-                ps->priority_wait.SetInterval(WAIT_PRIORITY);
-            }
-
-            if((root_vect == ROOT_VECTOR) && ((options & 0x40) == 0x40))
-            {
-              //by setting this flag to false, 0xdd packets that may come in while the terminated data
-              //packets come in won't reset the priority_wait timer
-              (*it)->waited_for_dd = false;
-              if(start_code == STARTCODE_DMX)
-                (*it)->doing_dmx = false;
-
-              //"Upon receipt of a packet containing this bit set
-              //to a value of 1, a receiver shall enter network
-              //data loss condition.  Any property values in
-              //these packets shall be ignored"
-              (*it)->active.SetInterval(m_ssHLL);  //We factor in the hold last look time here, rather than 0
-
-              if((*it)->doing_per_channel)
-                  (*it)->priority_wait.SetInterval(m_ssHLL); //We factor in the hold last look time here, rather than 0
-
-              validpacket = false;
-              break;
-            }
-
-            //Based on the start code, update the timers
-            if(start_code == STARTCODE_DMX)
-            {
-                //No matter how valid, we got something -- but we'll tweak the interval for any hll change
-                (*it)->doing_dmx = true;
-                (*it)->active.SetInterval(WAIT_OFFLINE + m_ssHLL);
-            }
-            else if(start_code == STARTCODE_PRIORITY && (*it)->waited_for_dd)
-            {
-                (*it)->doing_per_channel = true;  //The source could have stopped sending dd for a while.
-                (*it)->priority_wait.Reset();
-            }
-
-            //Validate the sequence number, updating the stored one
-            //The two's complement math is to handle rollover, and we're explicitly
-            //doing assignment to force the type sizes.  A negative number means
-            //we got an "old" one, but we assume that anything really old is possibly
-            //due the device having rebooted and starting the sequence over.
-            int1 result = ((int1)sequence) - ((int1)((*it)->lastseq));
-            if(result!=1)
-                (*it)->jumps++;
-            if((result <= 0) && (result > -20))
-            {
-                validpacket = false;
-                (*it)->seqErr++;
-            }
-            else
-                (*it)->lastseq = sequence;
-
-            //This next bit is a little tricky.  We want to wait for dd packets (sampling period
-            //tweaks aside) and notify them with the dd packet first, but we don't want to do that
-            //if we've never seen a dmx packet from the source.
-            if(!(*it)->doing_dmx)
-            {
-                /* For fault finding an installation which only sends 0xdd for a universe
-                 * (For example: ETC Cobalt does this for, currenlty, unpatched universes with in it's network map)
-                 * We do want to say that having not sent dimmer data is a valid source/packet
-                 */
-                // validpacket = false;
-                (*it)->priority_wait.Reset();  //We don't want to let the priority timer run out
-            }
-            else if(!(*it)->waited_for_dd && validpacket)
-            {
-                if(start_code == STARTCODE_PRIORITY)
-                {
-                    (*it)->waited_for_dd = true;
-                    (*it)->doing_per_channel = true;
-                    (*it)->priority_wait.SetInterval(WAIT_OFFLINE + m_ssHLL);
-                    newsourcenotify = true;
-                }
-                else if((*it)->priority_wait.Expired())
-                {
-                    (*it)->waited_for_dd = true;
-                    (*it)->doing_per_channel = false;
-                    (*it)->priority_wait.SetInterval(WAIT_OFFLINE + m_ssHLL);  //In case the source later decides to sent 0xdd packets
-                    newsourcenotify = true;
-                }
-                else
-                    newsourcenotify = validpacket = false;
-            }
-
-        //Found the source, and we're ready to process the packet
+            // Unlike the other drops this loses a real source, so it is always worth a warning
+            quint64 suppressed;
+            if(m_drops.drop(sACNDropTooManySources, suppressed, QtWarningMsg))
+                qCWarning(sacnListenerLog) << "sACNListener: all" << SACN_MAX_SOURCES << "sources in use, ignoring"
+                                           << source_name << "(" << suppressed << "more since the last message)";
+            return;
         }
-    }
-
-    if(!validpacket)
-    {
-        qDebug() << "sACNListener" << QThread::currentThreadId() << ": Source coming up, not processing packet";
-        return;
-    }
-
-    if(!foundsource)  //Add a new source to the list
-    {
-        ps = new sACNSource();
-
-        m_sources.push_back(ps);
-
+        m_sourceTable.insert(source_cid, ps->slot);
         ps->universe = universe;
-        ps->active.SetInterval(WAIT_OFFLINE + m_ssHLL);
-        ps->lastseq = sequence;
         ps->src_cid = source_cid;
-        ps->src_valid = true;
-        ps->doing_dmx = (start_code == STARTCODE_DMX);
-        //If we are in the sampling period, let all packets through
-        if(m_isSampling)
-        {
-            ps->waited_for_dd = true;
-            ps->doing_per_channel = (start_code == STARTCODE_PRIORITY);
-            newsourcenotify = true;
-            ps->priority_wait.SetInterval(WAIT_OFFLINE + m_ssHLL);
-        }
-        else
-        {
-            //If we aren't sampling, we want the earlier logic to set the state
-            ps->doing_per_channel = ps->waited_for_dd = false;
-            newsourcenotify = false;
-            ps->priority_wait.SetInterval(WAIT_PRIORITY);
-        }
-
-        validpacket = newsourcenotify;
-
+        quint8 actions = SM::receive(*ps, false, input, sequence, m_isSampling, timeouts);
+        validpacket = actions & SM::Process;
+        newsourcenotify = actions & SM::Notify;
 
         // This is a brand new source
-        qDebug() << "sACNListener" << QThread::currentThreadId() << ": Found new source name " << source_name;
+        qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ": Found new source name " << source_name;
         m_mergeAll = true;
         emit sourceFound(ps);
     }
+    else
+    {
+        ps = m_sources[slot];
+        quint8 actions = SM::receive(*ps, true, input, sequence, m_isSampling, timeouts);
+        validpacket = actions & SM::Process;
+        newsourcenotify = actions & SM::Notify;
+        if(!validpacket)
+        {
+            SACN_LOG_DROP(m_drops, sACNDropSourceComingUp, "Source coming up, not processing packet");
+            // The packet can still have moved a timeout earlier
+            scheduleExpiration(ps);
+            m_sourceStats[ps->slot].write(ps->stats);
+            return;
+        }
+    }
 
     if (newsourcenotify)
     {
         // This is a source that came back online
-        qDebug() << "sACNListener" << QThread::currentThreadId() << ": Source came back name " << source_name;
+        qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ": Source came back name " << source_name;
         m_mergeAll = true;
         emit sourceChanged(ps);
     }
@@ -388,11 +523,9 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
     {
         ps->source_params_change = false;
 
-        QString name = QString::fromUtf8(source_name);
-
-        if(ps->ip != sender)
+        if(ps->ip.toIPv4Address() != packet.sender)
         {
-            ps->ip = sender;
+            ps->ip.setAddress(packet.sender);
             ps->source_params_change = true;
         }
 
@@ -407,11 +540,8 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
 
         if(start_code == STARTCODE_DMX)
         {
-            if(ps->name!=name)
-            {
-                ps->name = name;
+            if(ps->setName(source_name))
                 ps->source_params_change = true;
-            }
             if(ps->isPreview != preview)
             {
                 ps->isPreview = preview;
@@ -431,34 +561,20 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
                 ps->source_params_change = true;
             }
             // This is DMX
-            // Copy the last array back
-            memcpy(ps->last_level_array, ps->level_array, 512);
-            // Fill in the new array
-            memset(ps->level_array, 0, 512);
-            memcpy(ps->level_array, pdata, slot_count);
-            // Compare the two
-            for(int i=0; i<512; i++)
-            {
-                if(ps->level_array[i]!=ps->last_level_array[i])
-                {
-                    ps->dirty_array[i] |= true;
-                    ps->source_levels_change = true;
-                }
-            }
+            if(sACNUpdateFrame(ps->level_array, pdata, slot_count, ps->dirty_mask))
+                ps->source_levels_change = true;
 
             // Increment the frame counter - we count only DMX frames
             ps->fpsCounter++;
+            ps->updateArrival(packet.timestamp, sACNPacket::currentTime());
         }
         else if(start_code == STARTCODE_PRIORITY)
         {
             // Not sending DMX data, so process name and FPS
             if (ps->doing_dmx == false) {
 
-                if(ps->name!=name)
-                {
-                    ps->name = name;
+                if(ps->setName(source_name))
                     ps->source_params_change = true;
-                }
 
                 if(ps->fpsTimer.elapsed() >= 1000)
                 {
@@ -468,22 +584,12 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
                     ps->fpsCounter = 0;
                     ps->source_params_change = true;
                 }
-            }
 
-            // Copy the last array back
-            memcpy(ps->last_priority_array, ps->priority_array, 512);
-            // Fill in the new array
-            memset(ps->priority_array, 0, 512);
-            memcpy(ps->priority_array, pdata, slot_count);
-            // Compare the two
-            for(int i=0; i<512; i++)
-            {
-                if(ps->priority_array[i]!=ps->last_priority_array[i])
-                {
-                    ps->dirty_array[i] |= true;
-                    ps->source_levels_change = true;
-                }
+                ps->updateArrival(packet.timestamp, sACNPacket::currentTime());
             }
+
+            if(sACNUpdateFrame(ps->priority_array, pdata, slot_count, ps->dirty_mask))
+                ps->source_levels_change = true;
         }
 
         if(ps->source_params_change)
@@ -491,29 +597,21 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
             emit sourceChanged(ps);
             ps->source_params_change = false;
         }
+
+        // Merge even if nothing changed, monitored addresses are sampled by the merge
+        scheduleMerge();
     }
+    else if(m_mergeAll)
+        scheduleMerge();
+
+    scheduleExpiration(ps);
+    m_sourceStats[ps->slot].write(ps->stats);
 }
 
 void sACNListener::performMerge()
 {
-    //array of addresses to merge. to prevent duplicates and because you can have
-    //an odd collection of addresses, addresses[n] would be 'n' for the value in question
-    // and -1 if not required
-    int addresses_to_merge[512];
-    int number_of_addresses_to_merge = 0;
-
-    memset(addresses_to_merge, -1, sizeof(int) * 512);
-
-    {
-        QMutexLocker locker(&m_monitoredChannelsMutex);
-        foreach(int chan, m_monitoredChannels)
-        {
-            QPointF data;
-            data.setX(m_elapsedTime.nsecsElapsed()/1000000.0);
-            data.setY(mergedLevels().at(chan).level);
-            emit dataReady(chan, data);
-        }
-    }
+    m_mergeScheduled = false;
+    TockCacheScope tockCache;
 
     if(m_mergesPerSecondTimer.hasExpired(1000))
     {
@@ -524,145 +622,230 @@ void sACNListener::performMerge()
 
     m_mergeCounter++;
 
-
+    // Forget the changes of the last merge
+    for(int address = m_changedMask.next(0); address < 512; address = m_changedMask.next(address + 1))
+        m_merged_levels[address].changedSinceLastMerge = false;
+    m_changedMask.clear();
 
     // Step one : find any addresses which have changed
     if(m_mergeAll) // Act like all addresses changed
     {
-        number_of_addresses_to_merge = 512;
-        for(int i=0; i<512; i++)
+        m_mergeMask.setAll();
+        m_mergeAll = false;
+    }
+    for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
+    {
+        sACNSource *ps = *it;
+        if(!ps->src_valid)
+            continue; // Inactive source, ignore it
+        if(!ps->source_levels_change)
+            continue; // We don't need to consider this one, no change
+        m_mergeMask |= ps->dirty_mask;
+        if(m_mergePolicy.load(std::memory_order_relaxed) == sACNMergeLTP)
         {
-            addresses_to_merge[i] = i;
+            for(int address = ps->dirty_mask.next(0); address < 512; address = ps->dirty_mask.next(address + 1))
+                m_lastChanged[address] = uint1(ps->slot);
         }
+        // Clear the flags
+        ps->dirty_mask.clear();
+        ps->source_levels_change = false;
+    }
 
-        m_mergeAll = false;
+    if(!m_mergeMask.any())
+    {
+        // Nothing to do
+        sampleMonitoredAddresses();
+        return;
     }
-    else
+
+    // Gather the valid sources
+    sACNSource *rowSources[SACN_MAX_SOURCES];
+    int rows = 0;
+    // Slots of the sources which are currently sending
+    quint64 sending = 0;
+    for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
     {
-        for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
+        sACNSource *ps = *it;
+        if(!ps->src_valid)
+            continue;
+
+        if(!ps->active.Expired())
         {
-            sACNSource *ps = *it;
-            if(!ps->src_valid)
-                continue; // Inactive source, ignore it
-            if(!ps->source_levels_change)
-                continue; // We don't need to consider this one, no change
-            for(int i=0; i<512; i++)
+            if(!ps->doing_per_channel)
             {
-                if(ps->dirty_array[i])
-                {
-                    addresses_to_merge[i] = i;
-                    number_of_addresses_to_merge++;
-                }
+                // Set the priority array for sources which are not doing per-channel
+                memset(ps->priority_array, ps->priority, sizeof(ps->priority_array));
             }
-            // Clear the flags
-            memset(ps->dirty_array, 0 , 512);
-            ps->source_levels_change = false;
+            sending |= Q_UINT64_C(1) << ps->slot;
         }
+        rowSources[rows++] = ps;
     }
 
-    if(number_of_addresses_to_merge == 0) return; // Nothing to do
-
-    // Clear out the sources list for all the affected channels, we'll be refreshing it
-
-    int skipCounter = 0;
-    for(int i=0; i < 512 && i<(number_of_addresses_to_merge + skipCounter); i++)
+    // Order them as the policy needs
+    sACNMergePolicy policy = m_mergePolicy.load(std::memory_order_relaxed);
+    if(policy == sACNMergeMostRecent)
     {
-        m_merged_levels[i].changedSinceLastMerge = false;
-        if(addresses_to_merge[i] == -1) {
-            ++skipCounter;
-            continue;
+        std::sort(rowSources, rowSources + rows, [](const sACNSource *a, const sACNSource *b) {
+            return a->last_arrival > b->last_arrival;
+        });
+    }
+    else if(policy == sACNMergeForcedSource)
+    {
+        int forcedRow = -1;
+        for(int row = 0; row < rows; row++)
+        {
+            if(rowSources[row]->src_cid == m_forcedSource)
+                forcedRow = row;
         }
-        sACNMergedAddress *pAddr = &m_merged_levels[addresses_to_merge[i]];
-        pAddr->otherSources.clear();
+        if(forcedRow >= 0)
+            std::swap(rowSources[0], rowSources[forcedRow]);
+        else
+            policy = sACNMergeHTP; // Not here, nothing to force
     }
 
-    // Find the highest priority source for each address we need to work on
-
-    int levels[512];
-    memset(&levels, -1, sizeof(levels));
-
-    int priorities[512];
-    memset(&priorities, -1, sizeof(priorities));
+    sACNMergeInput input;
+    input.rows = rows;
+    input.lastChanged = m_lastChanged;
+    for(int row = 0; row < rows; row++)
+    {
+        input.levels[row] = rowSources[row]->level_array;
+        input.priorities[row] = rowSources[row]->priority_array;
+        input.perChannel[row] = rowSources[row]->doing_per_channel;
+        input.ids[row] = uint1(rowSources[row]->slot);
+        // Readers of the frame on other threads know the winners by their CID
+        rowSources[row]->src_cid.Pack(m_frame.sourceCids[rowSources[row]->slot]);
+    }
 
-    QMultiMap<int, sACNSource*> addressToSourceMap;
+    // Find the highest priority sources for each address, and the winner among them
+    sACNMergeOutput output;
+    sACNMerge(policy, input, m_mergeMask, output);
+    const uint1 *levels = output.levels;
+    const uint1 *priorities = output.priorities;
+    const uint1 *winners = output.winners;
 
-	// Find the highest priority for the address
-    for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
+    // The addresses whose level or winner changed
+    sACNAddressMask changed;
+    for(int address = m_mergeMask.next(0); address < 512; address = m_mergeMask.next(address + 1))
     {
-        sACNSource *ps = *it;
- 
-        if(ps->src_valid && !ps->active.Expired() && !ps->doing_per_channel)
+        sACNMergedAddress &merged = m_merged_levels[address];
+        int level = -1;
+        sACNSource *winner = nullptr;
+        if(winners[address] != SACN_NO_WINNER)
         {
-            // Set the priority array for sources which are not doing per-channel
-            memset(ps->priority_array, ps->priority, sizeof(ps->priority_array));
+            level = levels[address];
+            winner = rowSources[winners[address]];
         }
 
-        skipCounter = 0;
-        for(int i=0; i < 512 && i<(number_of_addresses_to_merge + skipCounter); i++)
-        {
-            if(addresses_to_merge[i] == -1) {
-               ++skipCounter;
-                continue;
-            }
-            sACNMergedAddress *pAddr = &m_merged_levels[addresses_to_merge[i]];
-            int address = addresses_to_merge[i];
-
-			if (
-					ps->src_valid // Valid Source
-					&& !(ps->priority_array[address] < priorities[address]) // Not lesser priority
-					&& ( (ps->priority_array[address] > 0) || (ps->priority_array[address] == 0 && !ps->doing_per_channel) ) // Priority > 0 if DD
-				)
-			{
-				if (ps->priority_array[address] > priorities[address])
-				{
-					// Source of higher priority
-					priorities[address] = ps->priority_array[address];
-					addressToSourceMap.remove(address);
-				}
-				addressToSourceMap.insert(address, ps);
-			}
-
-            if(ps->src_valid && !ps->active.Expired())
-                pAddr->otherSources << ps;
-        }
-    }
+        merged.changedSinceLastMerge = (merged.level != level);
+        if(merged.changedSinceLastMerge)
+            m_changedMask.set(address);
+        if(merged.changedSinceLastMerge || merged.winningSource != winner)
+            changed.set(address);
+        merged.level = level;
+        merged.winningSource = winner;
 
+        // Everybody sending but the winner
+        merged.otherSources = winner ? sending & ~(Q_UINT64_C(1) << winner->slot) : 0;
 
+        m_frame.levels[address] = levels[address];
+        m_frame.priorities[address] = priorities[address];
+        m_frame.winners[address] = winner ? uint1(winner->slot) : uint1(SACN_NO_WINNER);
+    }
+    m_frame.version++;
+    m_publishedFrame.write(m_frame);
+    m_mergeMask.clear();
+    sampleMonitoredAddresses();
 
-    // Next, find highest level for the highest prioritized sources
-    skipCounter = 0;
-    for(int i=0; i < 512 && i<(number_of_addresses_to_merge + skipCounter); i++)
+    // Tell people..
+    emit levelsChanged();
+    if(changed.any())
     {
-        if(addresses_to_merge[i] == -1) {
-            ++skipCounter;
-            continue;
-        }
-        int address = addresses_to_merge[i];
-        QList<sACNSource*> sourceList = addressToSourceMap.values(address);
+        QMutexLocker locker(&m_subscribersMutex);
+        foreach(sACNLevelsSubscriber *subscriber, m_subscribers)
+            subscriber->post(changed, m_frame.version);
+    }
+}
 
-        if(sourceList.count() == 0)
-        {
-            m_merged_levels[address].level = -1;
-            m_merged_levels[address].winningSource = nullptr;
-            m_merged_levels[address].otherSources.clear();
-        }
-        foreach(sACNSource *s, sourceList)
+void sACNListener::sampleMonitoredAddresses()
+{
+    static const QMetaMethod dataReadySignal = QMetaMethod::fromSignal(&sACNListener::dataReady);
+    qint64 now = 0;
+    bool emitDataReady = false;
+    for(int word = 0; word < sACNAddressMask::Words; word++)
+    {
+        for(quint64 bits = m_monitoredAddresses[word].load(std::memory_order_acquire); bits; bits &= bits - 1)
         {
-            if(s->level_array[address] > levels[address])
+            if(!now)
             {
-                levels[address] = s->level_array[address];
-                m_merged_levels[address].changedSinceLastMerge = (m_merged_levels[address].level != levels[address]);
-                m_merged_levels[address].level = levels[address];
-                m_merged_levels[address].winningSource = s;
+                now = sACNPacket::currentTime();
+                emitDataReady = isSignalConnected(dataReadySignal);
             }
+            int address = word * 64 + qCountTrailingZeroBits(bits);
+            int level = m_merged_levels.at(address).level;
+            m_sampleRings[address].load(std::memory_order_acquire)->push(now, level);
+            // The old interface, only paid for by those who still use it
+            if(emitDataReady)
+                emit dataReady(address, QPointF((now - m_startTime) / 1000000.0, level));
         }
-        // Remove the winning source from the list of others
-        if(m_merged_levels[address].winningSource)
-            m_merged_levels[address].otherSources.remove(m_merged_levels[address].winningSource);
     }
+}
 
+void sACNListener::monitorAddress(int address)
+{
+    if(!m_sampleRings[address].load(std::memory_order_acquire))
+    {
+        // Another thread might be doing the same, the first one wins
+        sACNSampleRing *ring = new sACNSampleRing(SAMPLE_RING_SIZE);
+        sACNSampleRing *expected = nullptr;
+        if(!m_sampleRings[address].compare_exchange_strong(expected, ring, std::memory_order_acq_rel))
+            delete ring;
+    }
+    // Published after the ring, so the merge always finds it
+    m_monitoredAddresses[address >> 6].fetch_or(Q_UINT64_C(1) << (address & 63), std::memory_order_release);
+}
 
-    // Tell people..
-    emit levelsChanged();
+void sACNListener::unMonitorAddress(int address)
+{
+    m_monitoredAddresses[address >> 6].fetch_and(~(Q_UINT64_C(1) << (address & 63)), std::memory_order_relaxed);
+}
+
+int sACNListener::readSamples(int address, sACNSample *samples, int maxCount)
+{
+    sACNSampleRing *ring = m_sampleRings[address].load(std::memory_order_acquire);
+    return ring ? ring->read(samples, maxCount) : 0;
+}
+
+quint64 sACNListener::lostSamples(int address)
+{
+    sACNSampleRing *ring = m_sampleRings[address].load(std::memory_order_acquire);
+    return ring ? ring->lost() : 0;
 }
 
+void sACNListener::setMergePolicy(sACNMergePolicy policy, const CID &forcedSource)
+{
+    // Applied on the thread of the listener, between two merges
+    QMetaObject::invokeMethod(this, "applyMergePolicy", Qt::QueuedConnection,
+                              Q_ARG(int, policy), Q_ARG(CID, forcedSource));
+}
+
+void sACNListener::applyMergePolicy(int policy, const CID &forcedSource)
+{
+    m_mergePolicy.store(sACNMergePolicy(policy), std::memory_order_relaxed);
+    m_forcedSource = forcedSource;
+    memset(m_lastChanged, SACN_NO_WINNER, sizeof(m_lastChanged));
+    m_mergeAll = true;
+    scheduleMerge();
+    flushMerge();
+}
+
+void sACNListener::addSubscriber(sACNLevelsSubscriber *subscriber)
+{
+    QMutexLocker locker(&m_subscribersMutex);
+    m_subscribers << subscriber;
+}
+
+void sACNListener::removeSubscriber(sACNLevelsSubscriber *subscriber)
+{
+    QMutexLocker locker(&m_subscribersMutex);
+    m_subscribers.removeAll(subscriber);
+}
@@ -22,9 +22,18 @@
 #include <list>
 #include <QTimer>
 #include <QElapsedTimer>
-#include <QPoint>
+#include <QPointF>
 #include "streamingacn.h"
 #include "sacnsocket.h"
+#include "sacnpacket.h"
+#include "sacnsourcetable.h"
+#include "sacnseqlock.h"
+#include "sacnsamplering.h"
+#include "sacnkernels.h"
+#include "sacntimerwheel.h"
+#include "sacnlog.h"
+
+class sACNLevelsSubscriber;
 
 /**
  * @brief The sACNMergedAddress struct contains the current level of a specific channel and
@@ -35,6 +44,7 @@ struct sACNMergedAddress
     sACNMergedAddress() {
         level = -1;
         winningSource = nullptr;
+        otherSources = 0;
         changedSinceLastMerge = false;
     }
     /**
@@ -46,9 +56,22 @@ struct sACNMergedAddress
      */
     sACNSource *winningSource;
     /**
-     * @brief otherSources are pointers to other sources sending this address
+     * @brief otherSources are the other sources sending this address, bit n is set for the source
+     * in slot n. Use sACNListener::otherSources() or takeSlot() to get the sources.
      */
-    QSet<sACNSource *> otherSources;
+    quint64 otherSources;
+    int otherSourceCount() const { return qPopulationCount(otherSources); }
+    bool hasOtherSource(const sACNSource *source) const { return (otherSources >> source->slot) & 1; }
+    /**
+     * @brief takeSlot removes the lowest slot from bits, iterate otherSources with
+     * for(quint64 bits = address.otherSources; bits;) listener->source(sACNMergedAddress::takeSlot(bits));
+     * @return the slot removed
+     */
+    static int takeSlot(quint64 &bits) {
+        int slot = qCountTrailingZeroBits(bits);
+        bits &= bits - 1;
+        return slot;
+    }
     /**
      * @brief changedSinceLastMerge is true if the value changed during last merge
      */
@@ -57,6 +80,55 @@ struct sACNMergedAddress
 
 typedef QList<sACNMergedAddress> sACNMergedSourceList;
 
+/**
+ * @brief The sACNMergedFrame struct is a complete result of one merge, as published by
+ * sACNListener::mergedFrame()
+ */
+struct sACNMergedFrame
+{
+    sACNMergedFrame() {
+        version = 0;
+        memset(levels, 0, sizeof(levels));
+        memset(priorities, 0, sizeof(priorities));
+        memset(winners, SACN_NO_WINNER, sizeof(winners));
+        memset(sourceCids, 0, sizeof(sourceCids));
+    }
+    /**
+     * @brief version counts the merges, 0 before the first one
+     */
+    quint64 version;
+    /**
+     * @brief levels DMX value of each address, 0 if nobody is sending it
+     */
+    uint1 levels[512];
+    /**
+     * @brief priorities the priority of the winning source of each address
+     */
+    uint1 priorities[512];
+    /**
+     * @brief winners the slot of the winning source of each address, SACN_NO_WINNER if none.
+     * Slots are reused for new sources, so off the listener thread use winnerCid() instead of
+     * sACNListener::source()
+     */
+    uint1 winners[512];
+    /**
+     * @brief sourceCids the packed CID of the source in each slot, as of this merge
+     */
+    uint1 sourceCids[SACN_MAX_SOURCES][CID::CIDBYTES];
+
+    bool isValid(int address) const { return winners[address] != SACN_NO_WINNER; }
+    /**
+     * @brief level
+     * @return the level of the address like sACNMergedAddress::level, -1 if invalid
+     */
+    int level(int address) const { return isValid(address) ? levels[address] : -1; }
+    /**
+     * @brief winnerCid
+     * @return the CID of the winning source of the address, a null CID if invalid
+     */
+    CID winnerCid(int address) const { return isValid(address) ? CID(sourceCids[winners[address]]) : CID(); }
+};
+
 /**
  * @brief The sACNListener class is used to listen to  a universe of sACN.
  * The class should not be instantiated directly; instead use sACNManager to get the
@@ -80,57 +152,218 @@ public:
      * the result of the merge algorithm together with all the sub-sources, by address
      */
     sACNMergedSourceList mergedLevels() { return m_merged_levels;}
+    /**
+     * @brief mergedFrame copies the result of the last merge, can be called from any thread
+     * without locking and without ever seeing a partly merged frame
+     */
+    void mergedFrame(sACNMergedFrame &frame) const { m_publishedFrame.read(frame); }
+    /**
+     * @brief copyLevels copies just the merged levels of the last merge, from any thread
+     * @param levels 512 bytes, 0 for addresses nobody is sending
+     * @return the version of the frame the levels belong to
+     */
+    quint64 copyLevels(uint1 *levels) const;
 
+    /**
+     * @brief sourceCount
+     * @return the number of slots in the source arena, sources in unused slots have src_valid false
+     */
     std::size_t sourceCount() { return m_sources.size();}
+    /**
+     * @brief source must only be called on the thread of the listener, slots are reused as
+     * sources come and go
+     * @return the source in the slot index
+     */
     sACNSource *source(std::size_t index) { return m_sources[index];}
+    /**
+     * @brief releaseSource tells the listener that a receiver of sourceRemoved() is done with
+     * the source, can be called from any thread. The source is deleted after the last release.
+     */
+    void releaseSource(sACNSource *source);
+    /**
+     * @brief setDeleteRemovedSources opts in to deleting removed sources when nothing is connected
+     * to sourceRemoved(). By default they are kept until the listener is destroyed, since the
+     * pointers passed by sourceFound() and the other source signals may still be held. Only
+     * enable it if no receiver keeps those pointers or gets the signals queued to another thread.
+     */
+    void setDeleteRemovedSources(bool enable) { m_deleteRemovedSources.store(enable, std::memory_order_relaxed); }
+    /**
+     * @brief otherSources
+     * @return the sources of sACNMergedAddress::otherSources
+     */
+    QList<sACNSource *> otherSources(const sACNMergedAddress &address);
+
+    /**
+     * @brief sourceStats copies the network statistics of a source as of its last packet,
+     * can be called from any thread without locking until sourceRemoved() was emitted for it
+     */
+    void sourceStats(const sACNSource *source, sACNSourceStats &stats) const { m_sourceStats[source->slot].read(stats); }
 
     /**
      *  @brief processDatagram Process a suspected sACN datagram.
      * This allows other listeners to pass on unicast datagrams for other universes
      */
     void processDatagram(QByteArray data, QHostAddress receiver, QHostAddress sender);
+    /**
+     * @brief processPacket Process a suspected sACN datagram in place, without copying it.
+     * The merge is left for flushMerge(), call it once the batch of packets has been processed.
+     */
+    void processPacket(const sACNPacket &packet);
+    /**
+     * @brief flushMerge performs the merge scheduled by the packets processed since the last one, if any
+     */
+    void flushMerge();
+    /**
+     * @brief queuePacket hands a packet to this listener from any thread, it is processed
+     * later on the thread of the listener
+     * @return false if the queue was full and the packet was dropped
+     */
+    bool queuePacket(const sACNPacket &packet);
+
+    /**
+     * @brief setMergePolicy selects how the winner of an address is picked among the sources with
+     * the highest priority, sACNMergeHTP by default. Can be called from any thread.
+     * @param forcedSource the CID of the source which wins wherever it sends, for sACNMergeForcedSource
+     */
+    void setMergePolicy(sACNMergePolicy policy, const CID &forcedSource = CID());
+    /**
+     * @brief mergePolicy can be called from any thread, a new policy shows once it is applied
+     */
+    sACNMergePolicy mergePolicy() const { return m_mergePolicy.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief addSubscriber and removeSubscriber are used by sACNLevelsSubscriber,
+     * they can be called from any thread
+     */
+    void addSubscriber(sACNLevelsSubscriber *subscriber);
+    void removeSubscriber(sACNLevelsSubscriber *subscriber);
+
+    /**
+     * @brief readSamples takes the samples of a monitored address recorded since the last call,
+     * oldest first. It never blocks the listener, but only one thread may read each address.
+     * Use sACNSampleRing::minMax() or decimate() to reduce them for long time windows.
+     * @return the number of samples copied, at most maxCount
+     */
+    int readSamples(int address, sACNSample *samples, int maxCount);
+    /**
+     * @brief lostSamples
+     * @return the number of samples of the address which were overwritten before being read
+     */
+    quint64 lostSamples(int address);
+
+    /**
+     * @brief droppedPackets can be called from any thread
+     * @return the number of packets ignored for the reason since the listener was created
+     */
+    quint64 droppedPackets(sACNDropReason reason) const { return m_drops.count(reason); }
 
     // Diagnostic - the number of merge operations per second
 
     unsigned int mergesPerSecond() { return (m_mergesPerSecond > 0) ? m_mergesPerSecond : 0;}
 public slots:
     void startReception();
-    void monitorAddress(int address) {
-        QMutexLocker locker(&m_monitoredChannelsMutex);
-        m_monitoredChannels.insert(address);
-    }
-    void unMonitorAddress(int address) {
-        QMutexLocker locker(&m_monitoredChannelsMutex);
-        m_monitoredChannels.remove(address);
-    }
+    /**
+     * @brief setSourceReclaimTime sets how long a source has to be offline before it is forgotten
+     * and its slot is reused
+     * @param ms time in milliseconds
+     */
+    void setSourceReclaimTime(int ms) { m_sourceReclaimTime = ms; }
+    /**
+     * @brief monitorAddress starts recording the level of an address at every merge,
+     * read the samples with readSamples()
+     */
+    void monitorAddress(int address);
+    void unMonitorAddress(int address);
 signals:
     void sourceFound(sACNSource *source);
     void sourceLost(sACNSource *source);
     void sourceChanged(sACNSource *source);
+    /**
+     * @brief sourceRemoved is emitted when an offline source is forgotten. Its slot gets a new
+     * object right away, the removed one stays valid until every slot connected to this signal
+     * has dropped its pointers to it and called releaseSource() once. With nothing connected it
+     * stays valid while the listener exists, see setDeleteRemovedSources(). Receivers of the other
+     * source signals, and holders of sACNMergedAddress::winningSource copies, must connect to it
+     * to keep their pointers valid.
+     */
+    void sourceRemoved(sACNSource *source);
     void levelsChanged();
+    /**
+     * @brief dataReady is emitted for every sample recorded of a monitored address, x in ms
+     * since the listener was created and y the level.
+     * @deprecated One queued signal per address and merge is costly, use readSamples() instead
+     */
     void dataReady(int address, QPointF data);
 private slots:
     void readPendingDatagrams();
+    void processQueuedPackets();
     void performMerge();
     void checkSourceExpiration();
+    void applyMergePolicy(int policy, const CID &forcedSource);
+    void sourceReleased(sACNSource *source);
     void sampleExpiration();
 private:
     std::list<sACNRxSocket *> m_sockets;
+    // Packets handed over by other threads
+    sACNPacketQueue m_packetQueue;
+    std::atomic<bool> m_packetQueueNotified;
+    // Sources by slot, slots of long lost sources are reclaimed through m_freeSlots
     std::vector<sACNSource *> m_sources;
+    sACNSourceTable m_sourceTable;
+    std::vector<int> m_freeSlots;
+    int m_sourceReclaimTime;
+    // A forgotten source, kept until every receiver of sourceRemoved() has released it,
+    // or until the listener is destroyed if it had none
+    struct RetiredSource
+    {
+        sACNSource *source;
+        int pendingReleases;
+    };
+    std::vector<RetiredSource> m_retiredSources;
+    std::atomic<bool> m_deleteRemovedSources;
+    sACNSource *allocateSource();
+    void retireSource(sACNSource *ps);
     int m_last_levels[512];
     sACNMergedSourceList m_merged_levels;
+    // The merge result published to other threads, and the copy it is built in
+    sACNMergedFrame m_frame;
+    sACNSeqLock<sACNMergedFrame> m_publishedFrame;
+    // sACNSource::stats by slot, for other threads
+    sACNSeqLock<sACNSourceStats> m_sourceStats[SACN_MAX_SOURCES];
+    QMutex m_subscribersMutex;
+    QList<sACNLevelsSubscriber *> m_subscribers;
     int m_universe;
     // The per-source hold last look time
     int m_ssHLL;
     // Are we in the initial sampling state
     bool m_isSampling;
     QTimer *m_initalSampleTimer;
-    QTimer *m_mergeTimer;
-    QElapsedTimer m_elapsedTime;
+    // The next timeout of each source by slot, m_expirationTimer fires when the
+    // next bucket of the wheel comes up
+    sACNTimerWheel m_expiryWheel;
+    QTimer *m_expirationTimer;
+    void scheduleExpiration(sACNSource *ps);
+    void armExpirationTimer(quint32 now);
+    int nextExpiration(sACNSource *ps);
+    // A merge is due at the end of the current batch, see flushMerge()
+    bool m_mergeScheduled;
+    void scheduleMerge();
+    std::atomic<sACNMergePolicy> m_mergePolicy;
+    CID m_forcedSource;
+    // sACNMergeLTP: the slot of the source which changed each address last
+    uint1 m_lastChanged[512];
     int m_predictableTimerValue;
-    QMutex m_monitoredChannelsMutex;
-    QSet<int> m_monitoredChannels;
+    // The monitored addresses, a bit per address like sACNAddressMask
+    std::atomic<quint64> m_monitoredAddresses[sACNAddressMask::Words];
+    // Samples of monitored addresses, created on first use and kept while the listener exists
+    std::atomic<sACNSampleRing *> m_sampleRings[512];
+    // Sample time of the creation of the listener, for dataReady()
+    qint64 m_startTime;
+    void sampleMonitoredAddresses();
     bool m_mergeAll; // A flag to initiate a complete remerge of everything
+    sACNAddressMask m_mergeMask; // The addresses to merge next
+    sACNAddressMask m_changedMask; // The addresses with changedSinceLastMerge set
+    sACNDropCounters m_drops;
     unsigned int m_mergesPerSecond;
     int m_mergeCounter;
     QElapsedTimer m_mergesPerSecondTimer;
@@ -0,0 +1,43 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnlog.h"
+
+Q_LOGGING_CATEGORY(sacnListenerLog, "sacn.listener")
+
+sACNDropCounters::sACNDropCounters()
+{
+    for(int i = 0; i < sACNDropReasonCount; i++)
+    {
+        m_count[i].store(0);
+        m_logged[i] = 0;
+    }
+}
+
+void sACNDropCounters::drop(sACNDropReason reason)
+{
+    // Only the listener thread writes, so no atomic read-modify-write is needed
+    m_count[reason].store(m_count[reason].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+bool sACNDropCounters::drop(sACNDropReason reason, quint64 &suppressed, QtMsgType type)
+{
+    drop(reason);
+    if(!sacnListenerLog().isEnabled(type) || !m_logTimer[reason].Expired())
+        return false;
+
+    quint64 total = count(reason);
+    suppressed = total - m_logged[reason] - 1;
+    m_logged[reason] = total;
+    m_logTimer[reason].SetInterval(SACN_DROP_LOG_INTERVAL);
+    return true;
+}
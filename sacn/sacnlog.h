@@ -0,0 +1,89 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNLOG_H
+#define SACNLOG_H
+
+#include <QLoggingCategory>
+#include <QThread>
+#include <atomic>
+#include "ACNShare/deftypes.h"
+#include "ACNShare/tock.h"
+
+// The log category of the listeners, "sacn.listener"
+Q_DECLARE_LOGGING_CATEGORY(sacnListenerLog)
+
+// The least amount of ms between two messages about packets dropped for the same reason
+#define SACN_DROP_LOG_INTERVAL 1000
+
+/**
+ * @brief The sACNDropReason enum lists why a listener ignores a packet
+ */
+enum sACNDropReason
+{
+    sACNDropInvalid,            // Not a valid sACN packet
+    sACNDropWrongUniverse,      // Multicast for another universe
+    sACNDropPreview,            // Preview data
+    sACNDropTooManySources,     // All SACN_MAX_SOURCES slots are in use
+    sACNDropSourceComingUp,     // Sequence error, or the source is waiting for 0xdd packets
+    sACNDropReasonCount
+};
+
+/**
+ * @brief The sACNDropCounters class counts the packets a listener dropped for each reason.
+ * Only the listener thread drops packets, the counts can be read from any thread.
+ */
+class sACNDropCounters
+{
+public:
+    sACNDropCounters();
+
+    quint64 count(sACNDropReason reason) const { return m_count[reason].load(std::memory_order_relaxed); }
+
+    /**
+     * @brief drop counts a dropped packet
+     * @param suppressed set to the number of drops not logged since the last message
+     * @param type the level the message would be logged at
+     * @return true if the drop should be logged, at most once per SACN_DROP_LOG_INTERVAL for each reason
+     */
+    bool drop(sACNDropReason reason, quint64 &suppressed, QtMsgType type = QtDebugMsg);
+    void drop(sACNDropReason reason);
+
+private:
+    std::atomic<quint64> m_count[sACNDropReasonCount];
+    quint64 m_logged[sACNDropReasonCount];
+    ttimer m_logTimer[sACNDropReasonCount];
+};
+
+/**
+ * SACN_LOG_DROP counts a dropped packet and logs message to sacnListenerLog, unless a message
+ * for the same reason was logged recently. With SACN_NO_DROP_LOG or QT_NO_DEBUG_OUTPUT defined
+ * it only counts.
+ */
+#if defined(SACN_NO_DROP_LOG) || defined(QT_NO_DEBUG_OUTPUT)
+#define SACN_LOG_DROP(drops, reason, message) (drops).drop(reason)
+#else
+#define SACN_LOG_DROP(drops, reason, message) \
+    do { \
+        quint64 sacnSuppressed; \
+        if((drops).drop(reason, sacnSuppressed)) \
+        { \
+            if(sacnSuppressed) \
+                qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ":" << message \
+                                         << "(" << sacnSuppressed << "more since the last message)"; \
+            else \
+                qCDebug(sacnListenerLog) << "sACNListener" << QThread::currentThreadId() << ":" << message; \
+        } \
+    } while(false)
+#endif
+
+#endif // SACNLOG_H
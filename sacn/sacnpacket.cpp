@@ -0,0 +1,111 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnpacket.h"
+
+#include <new>
+#include <string.h>
+
+#ifdef Q_OS_LINUX
+#include <time.h>
+#else
+#include <QDateTime>
+#endif
+
+qint64 sACNPacket::currentTime()
+{
+#ifdef Q_OS_LINUX
+    // The kernel timestamps packets with the realtime clock
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+    return QDateTime::currentMSecsSinceEpoch() * 1000000;
+#endif
+}
+
+sACNPacketPool::sACNPacketPool(int count) :
+    m_count(count)
+{
+    // operator new only guarantees the alignment of max_align_t before C++17
+    m_packets = static_cast<sACNPacket*>(qMallocAligned(sizeof(sACNPacket) * count, alignof(sACNPacket)));
+    for(int i=0; i<count; i++)
+    {
+        new (&m_packets[i]) sACNPacket();
+        m_packets[i].length = -1;
+    }
+}
+
+sACNPacketPool::~sACNPacketPool()
+{
+    qFreeAligned(m_packets);
+}
+
+sACNPacketQueue::sACNPacketQueue(int capacity) :
+    m_packets(capacity),
+    m_sequences(capacity),
+    m_mask(capacity - 1),
+    m_enqueuePosition(0),
+    m_dequeuePosition(0)
+{
+    Q_ASSERT((capacity & (capacity - 1)) == 0);
+    for(int i=0; i<capacity; i++)
+        m_sequences[i].store(i, std::memory_order_relaxed);
+}
+
+bool sACNPacketQueue::push(const sACNPacket &packet)
+{
+    // Claim a slot
+    quint32 position = m_enqueuePosition.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        quint32 sequence = m_sequences[position & m_mask].load(std::memory_order_acquire);
+        qint32 difference = qint32(sequence - position);
+        if(difference == 0)
+        {
+            if(m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(difference < 0)
+        {
+            return false; // Full
+        }
+        else
+        {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Fill and publish it
+    sACNPacket &slot = m_packets[position & m_mask];
+    memcpy(slot.data, packet.data, packet.length);
+    slot.length = packet.length;
+    slot.sender = packet.sender;
+    slot.multicast = packet.multicast;
+    slot.timestamp = packet.timestamp;
+    m_sequences[position & m_mask].store(position + 1, std::memory_order_release);
+    return true;
+}
+
+const sACNPacket *sACNPacketQueue::front()
+{
+    quint32 sequence = m_sequences[m_dequeuePosition & m_mask].load(std::memory_order_acquire);
+    if(sequence != m_dequeuePosition + 1)
+        return nullptr;
+    return &m_packets[m_dequeuePosition & m_mask];
+}
+
+void sACNPacketQueue::pop()
+{
+    m_sequences[m_dequeuePosition & m_mask].store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+    m_dequeuePosition++;
+}
@@ -0,0 +1,120 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNPACKET_H
+#define SACNPACKET_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+#include "ACNShare/deftypes.h"
+
+// The size of one packet buffer, large enough for the biggest E1.31 packet (universe discovery)
+#define SACN_PACKET_SIZE 1144
+
+// Packet buffers are aligned to and padded to a multiple of this
+#define SACN_CACHE_LINE_SIZE 64
+
+/**
+ * @brief The sACNPacket struct is a reusable receive buffer together with the metadata of the
+ * datagram it currently holds. Packets live in a sACNPacketPool and are handed around by reference,
+ * the receive path never copies or allocates them.
+ */
+struct alignas(SACN_CACHE_LINE_SIZE) sACNPacket
+{
+    uint1 data[SACN_PACKET_SIZE];
+    /**
+     * @brief length of the datagram in data, -1 if the datagram was dropped
+     */
+    int length;
+    /**
+     * @brief sender IPv4 address of the sender, in host byte order
+     */
+    quint32 sender;
+    /**
+     * @brief multicast is true if the datagram was received on a multicast socket
+     */
+    bool multicast;
+    /**
+     * @brief timestamp the time the datagram was received, in ns since the epoch.
+     * Taken by the kernel where supported, otherwise when the datagram was read
+     */
+    qint64 timestamp;
+
+    /**
+     * @brief currentTime
+     * @return the current time on the clock used for timestamp
+     */
+    static qint64 currentTime();
+};
+
+/**
+ * @brief The sACNPacketPool class is a fixed set of cache aligned sACNPacket buffers,
+ * allocated once and reused for the lifetime of the pool
+ */
+class sACNPacketPool
+{
+public:
+    explicit sACNPacketPool(int count);
+    ~sACNPacketPool();
+
+    int count() const { return m_count; }
+    sACNPacket &operator[](int index) { return m_packets[index]; }
+    const sACNPacket &operator[](int index) const { return m_packets[index]; }
+
+private:
+    Q_DISABLE_COPY(sACNPacketPool)
+    sACNPacket *m_packets;
+    int m_count;
+};
+
+/**
+ * @brief The sACNPacketQueue class is a bounded, lock-free ring of packets used to hand datagrams
+ * to the thread of another listener. Any thread may push, only the owning thread may read.
+ * Pushing copies the datagram into a preallocated slot, nothing is allocated after construction.
+ */
+class sACNPacketQueue
+{
+public:
+    /**
+     * @param capacity the number of slots in the ring, must be a power of two
+     */
+    explicit sACNPacketQueue(int capacity);
+
+    /**
+     * @brief push copies a packet into the queue, safe to call from any thread
+     * @return false if the queue is full and the packet was dropped
+     */
+    bool push(const sACNPacket &packet);
+
+    /**
+     * @brief front returns the oldest packet of the queue, owning thread only
+     * @return the packet, or nullptr if the queue is empty
+     */
+    const sACNPacket *front();
+
+    /**
+     * @brief pop releases the packet returned by front(), owning thread only
+     */
+    void pop();
+
+private:
+    Q_DISABLE_COPY(sACNPacketQueue)
+    sACNPacketPool m_packets;
+    // Slot i is free for position p when its sequence equals p, and readable when it equals p + 1
+    std::vector<std::atomic<quint32> > m_sequences;
+    quint32 m_mask;
+    std::atomic<quint32> m_enqueuePosition;
+    quint32 m_dequeuePosition;
+};
+
+#endif // SACNPACKET_H
@@ -0,0 +1,117 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnsamplering.h"
+
+#include <string.h>
+
+sACNSampleRing::sACNSampleRing(int capacity) :
+    m_slots(new Slot[capacity]),
+    m_capacity(quint64(capacity)),
+    m_writing(0),
+    m_written(0),
+    m_read(0),
+    m_lost(0)
+{
+    Q_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+sACNSampleRing::~sACNSampleRing()
+{
+    delete[] m_slots;
+}
+
+void sACNSampleRing::push(qint64 time, int level)
+{
+    quint64 index = m_written.load(std::memory_order_relaxed);
+    // Readers check this after copying, to know which slots might have been overwritten meanwhile
+    m_writing.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Slot &slot = m_slots[index & (m_capacity - 1)];
+    slot.time.store(time, std::memory_order_relaxed);
+    slot.level.store(level, std::memory_order_relaxed);
+    m_written.store(index + 1, std::memory_order_release);
+}
+
+int sACNSampleRing::read(sACNSample *samples, int maxCount)
+{
+    quint64 written = m_written.load(std::memory_order_acquire);
+    if(written - m_read > m_capacity)
+    {
+        // Overwritten before we got to them
+        m_lost += written - m_capacity - m_read;
+        m_read = written - m_capacity;
+    }
+
+    int count = int(qMin<quint64>(written - m_read, quint64(maxCount)));
+    for(int i = 0; i < count; i++)
+    {
+        const Slot &slot = m_slots[(m_read + i) & (m_capacity - 1)];
+        samples[i].time = slot.time.load(std::memory_order_relaxed);
+        samples[i].level = slot.level.load(std::memory_order_relaxed);
+    }
+
+    // Drop what the writer may have overwritten while we were copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    quint64 writing = m_writing.load(std::memory_order_relaxed);
+    if(writing > m_capacity && m_read < writing - m_capacity)
+    {
+        int overwritten = int(qMin<quint64>(writing - m_capacity - m_read, quint64(count)));
+        memmove(samples, samples + overwritten, sizeof(sACNSample) * (count - overwritten));
+        count -= overwritten;
+        m_lost += overwritten;
+        m_read += overwritten;
+    }
+
+    m_read += count;
+    return count;
+}
+
+int sACNSampleRing::decimate(const sACNSample *samples, int count, int factor, sACNSample *out)
+{
+    if(factor < 1)
+        factor = 1;
+    int written = 0;
+    for(int i = 0; i < count; i += factor)
+        out[written++] = samples[i];
+    return written;
+}
+
+int sACNSampleRing::minMax(const sACNSample *samples, int count, qint64 interval, sACNSample *out)
+{
+    int written = 0;
+    int start = 0;
+    while(start < count)
+    {
+        // Find the extremes of this interval
+        qint64 end = samples[start].time + interval;
+        int lowest = start;
+        int highest = start;
+        int i = start + 1;
+        for(; i < count && samples[i].time < end; i++)
+        {
+            if(samples[i].level < samples[lowest].level)
+                lowest = i;
+            if(samples[i].level > samples[highest].level)
+                highest = i;
+        }
+
+        sACNSample first = samples[qMin(lowest, highest)];
+        sACNSample second = samples[qMax(lowest, highest)];
+        out[written++] = first;
+        if(lowest != highest)
+            out[written++] = second;
+        start = i;
+    }
+    return written;
+}
@@ -0,0 +1,90 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNSAMPLERING_H
+#define SACNSAMPLERING_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief The sACNSample struct is the level of a monitored address at one merge
+ */
+struct sACNSample
+{
+    qint64 time; // ns since the epoch, like sACNPacket::timestamp
+    int level;   // 0-255, -1 if nobody was sending
+};
+
+/**
+ * @brief The sACNSampleRing class records the samples of one address. One thread writes,
+ * one thread reads, neither ever waits for the other. When the reader falls behind, the oldest
+ * samples are overwritten and counted in lost().
+ */
+class sACNSampleRing
+{
+public:
+    /**
+     * @param capacity the number of samples kept, must be a power of two
+     */
+    explicit sACNSampleRing(int capacity);
+    ~sACNSampleRing();
+
+    /**
+     * @brief push records a sample, writer thread only
+     */
+    void push(qint64 time, int level);
+
+    /**
+     * @brief read takes the oldest unread samples, reader thread only
+     * @return the number of samples copied to samples, at most maxCount
+     */
+    int read(sACNSample *samples, int maxCount);
+
+    /**
+     * @brief lost
+     * @return the number of samples overwritten before they were read
+     */
+    quint64 lost() const { return m_lost; }
+
+    /**
+     * @brief decimate keeps every factor-th sample
+     * @return the number of samples written to out, which may be the same buffer as samples
+     */
+    static int decimate(const sACNSample *samples, int count, int factor, sACNSample *out);
+
+    /**
+     * @brief minMax reduces the samples of each interval of time to the lowest and the highest one,
+     * in the order they occurred, which keeps the peaks when drawing long windows
+     * @param interval the length of an interval in ns
+     * @return the number of samples written to out, which may be the same buffer as samples
+     */
+    static int minMax(const sACNSample *samples, int count, qint64 interval, sACNSample *out);
+
+private:
+    Q_DISABLE_COPY(sACNSampleRing)
+    struct Slot
+    {
+        std::atomic<qint64> time;
+        std::atomic<int> level;
+    };
+    Slot *m_slots;
+    quint64 m_capacity;
+    // Index of the sample being written, and the number of samples completely written
+    std::atomic<quint64> m_writing;
+    std::atomic<quint64> m_written;
+    // Reader side
+    quint64 m_read;
+    quint64 m_lost;
+};
+
+#endif // SACNSAMPLERING_H
@@ -317,6 +317,7 @@ void CStreamServer::RemovePSeq(const CID &cid, uint2 universe)
 void CStreamServer::Tick()
 {
     QMutexLocker locker(&m_writeMutex);
+    TockCacheScope tockCache;
 
     int valid_count = 0;
     for(verseiter it = m_multiverse.begin(); it != m_multiverse.end(); ++it)
@@ -0,0 +1,93 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNSEQLOCK_H
+#define SACNSEQLOCK_H
+
+#include <QtGlobal>
+#include <QThread>
+#include <atomic>
+#include <string.h>
+
+/**
+ * @brief The sACNSeqLock class publishes a plain value from one writer thread to readers on
+ * any thread without locks. Readers copy the value and retry if it was written meanwhile,
+ * so they never block the writer and always see a complete value.
+ * T must be trivially copyable.
+ */
+template<typename T>
+class sACNSeqLock
+{
+public:
+    sACNSeqLock() : m_sequence(0) { write(T()); }
+
+    /**
+     * @brief write publishes a new value, must only be called from one thread at a time
+     */
+    void write(const T &value)
+    {
+        quint32 sequence = m_sequence.load(std::memory_order_relaxed);
+        // An odd sequence tells readers that a write is in progress
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        const char *source = reinterpret_cast<const char *>(&value);
+        for(std::size_t i = 0; i < Words; i++)
+        {
+            quint64 word = 0;
+            memcpy(&word, source + i * 8, qMin<std::size_t>(8, sizeof(T) - i * 8));
+            m_words[i].store(word, std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief read copies the current value
+     * @return the number of writes so far
+     */
+    quint32 read(T &value) const { return readPart(&value, 0, sizeof(T)); }
+
+    /**
+     * @brief readPart copies size bytes of the current value, starting at offset, which must be
+     * a multiple of 8
+     * @return the number of writes so far
+     */
+    quint32 readPart(void *destination, std::size_t offset, std::size_t size) const
+    {
+        Q_ASSERT(offset % 8 == 0 && offset + size <= sizeof(T));
+        char *target = reinterpret_cast<char *>(destination);
+        for(;;)
+        {
+            quint32 before = m_sequence.load(std::memory_order_acquire);
+            if(!(before & 1))
+            {
+                for(std::size_t copied = 0; copied < size; copied += 8)
+                {
+                    quint64 word = m_words[(offset + copied) / 8].load(std::memory_order_relaxed);
+                    memcpy(target + copied, &word, qMin<std::size_t>(8, size - copied));
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(m_sequence.load(std::memory_order_relaxed) == before)
+                    return before / 2;
+            }
+            // The writer is busy, let it finish
+            QThread::yieldCurrentThread();
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(sACNSeqLock)
+    static const std::size_t Words = (sizeof(T) + 7) / 8;
+    std::atomic<quint32> m_sequence;
+    std::atomic<quint64> m_words[Words];
+};
+
+#endif // SACNSEQLOCK_H
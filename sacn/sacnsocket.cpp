@@ -22,6 +22,15 @@
 #include "ACNShare/ipaddr.h"
 #include "streamcommon.h"
 
+#ifdef Q_OS_LINUX
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#endif
+
 QNetworkInterface getDefaultNetworkInterface() {
 #ifdef Q_OS_MAC
     return QNetworkInterface();
@@ -79,9 +88,31 @@ void sACNTxSocket::setNetworkInterface(QNetworkInterface iface)
 }
 
 
-sACNRxSocket::sACNRxSocket(QObject *parent) : QUdpSocket(parent)
+sACNRxSocket::sACNRxSocket(QObject *parent) : QUdpSocket(parent),
+    m_multicast(false),
+    m_batch(SACN_RX_BATCH_SIZE)
 {
+#ifdef Q_OS_LINUX
+    // The message headers point at the batch buffers for the lifetime of the socket
+    memset(m_batchHeaders, 0, sizeof(m_batchHeaders));
+    for (int i = 0; i < SACN_RX_BATCH_SIZE; i++)
+    {
+        m_batchVectors[i].iov_base = m_batch[i].data;
+        m_batchVectors[i].iov_len = sizeof(m_batch[i].data);
+        m_batchHeaders[i].msg_hdr.msg_iov = &m_batchVectors[i];
+        m_batchHeaders[i].msg_hdr.msg_iovlen = 1;
+        m_batchHeaders[i].msg_hdr.msg_name = &m_batchSenders[i];
+    }
+#endif
+}
 
+void sACNRxSocket::enableTimestamps()
+{
+#ifdef Q_OS_LINUX
+    int one = 1;
+    if (setsockopt(socketDescriptor(), SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) != 0)
+        qDebug() << "sACNRxSocket " << QThread::currentThreadId() << ": Kernel timestamps not available";
+#endif
 }
 
 bool sACNRxSocket::bindMulticast(quint16 universe)
@@ -97,6 +128,7 @@ bool sACNRxSocket::bindMulticast(quint16 universe)
     ok = bind(addr.ToQHostAddress(),
                    addr.GetIPPort(),
                    QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint);
+    m_multicast = true;
 
     // Join multicast on selected NIC
     if (ok)
@@ -114,6 +146,7 @@ bool sACNRxSocket::bindMulticast(quint16 universe)
 
     if(ok)
     {
+        enableTimestamps();
         qDebug() << "sACNRxSocket " << QThread::currentThreadId() << ": Bound to interface:" << iface.name();
         qDebug() << "sACNRxSocket " << QThread::currentThreadId() << ": Joining Multicast Group:" << QHostAddress(addr.GetV4Address()).toString();
     }
@@ -141,6 +174,7 @@ bool sACNRxSocket::bindUnicast()
                       STREAM_IP_PORT,
                       QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint);
             if (ok) {
+                enableTimestamps();
                 qDebug() << "sACNRxSocket " << QThread::currentThreadId() << ": Bound to IP:" << ifaceAddr.ip().toString();
                 break;
             }
@@ -156,6 +190,126 @@ bool sACNRxSocket::bindUnicast()
     return ok;
 }
 
+int sACNRxSocket::readDatagramBatch()
+{
+    // The first datagram is always read through Qt, this re-arms the readyRead() notification
+    if (!hasPendingDatagrams())
+        return 0;
+    m_batch[0].length = readDatagram(reinterpret_cast<char*>(m_batch[0].data), sizeof(m_batch[0].data), &m_sender);
+    m_batch[0].sender = m_sender.toIPv4Address();
+    m_batch[0].multicast = m_multicast;
+    m_batch[0].timestamp = sACNPacket::currentTime();
+    int count = 1;
+
+#ifdef Q_OS_LINUX
+    // The kernel remembers the timestamp of the datagram read last
+    struct timespec stamp;
+    if (ioctl(socketDescriptor(), SIOCGSTAMPNS, &stamp) == 0)
+        m_batch[0].timestamp = qint64(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+
+    // Drain the rest of the queue with a single call
+    for (int i = count; i < SACN_RX_BATCH_SIZE; i++)
+    {
+        m_batchHeaders[i].msg_hdr.msg_namelen = sizeof(m_batchSenders[i]);
+        m_batchHeaders[i].msg_hdr.msg_control = m_batchControl[i];
+        m_batchHeaders[i].msg_hdr.msg_controllen = sizeof(m_batchControl[i]);
+    }
+
+    int received = recvmmsg(socketDescriptor(), &m_batchHeaders[count], SACN_RX_BATCH_SIZE - count,
+                            MSG_DONTWAIT, Q_NULLPTR);
+    for (int i = 0; i < received; i++, count++)
+    {
+        sACNPacket &packet = m_batch[count];
+        packet.multicast = m_multicast;
+        if (m_batchHeaders[count].msg_hdr.msg_flags & MSG_TRUNC)
+        {
+            // Too big to be sACN
+            packet.length = -1;
+            continue;
+        }
+        packet.length = m_batchHeaders[count].msg_len;
+        packet.sender = ntohl(m_batchSenders[count].sin_addr.s_addr);
+
+        packet.timestamp = 0;
+        struct msghdr *header = &m_batchHeaders[count].msg_hdr;
+        for (struct cmsghdr *control = CMSG_FIRSTHDR(header); control; control = CMSG_NXTHDR(header, control))
+        {
+            if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                memcpy(&stamp, CMSG_DATA(control), sizeof(stamp));
+                packet.timestamp = qint64(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+            }
+        }
+        if (!packet.timestamp)
+            packet.timestamp = sACNPacket::currentTime();
+    }
+#else
+    while (count < SACN_RX_BATCH_SIZE && hasPendingDatagrams())
+    {
+        sACNPacket &packet = m_batch[count++];
+        packet.length = readDatagram(reinterpret_cast<char*>(packet.data), sizeof(packet.data), &m_sender);
+        packet.sender = m_sender.toIPv4Address();
+        packet.multicast = m_multicast;
+        packet.timestamp = sACNPacket::currentTime();
+    }
+#endif
+
+    return count;
+}
+
+bool sACNRxSocket::bindUnicastShard(int cpu)
+{
+#if defined(Q_OS_LINUX) && defined(SO_REUSEPORT)
+    bool ok = false;
+
+    // Bind to first IPv4 address on selected NIC
+    QNetworkInterface iface = s_networkInterace;
+
+    foreach (QNetworkAddressEntry ifaceAddr, iface.addressEntries())
+    {
+        if (ifaceAddr.ip().protocol() != QAbstractSocket::IPv4Protocol)
+            continue;
+
+        // Qt can't set SO_REUSEPORT before binding, so create the socket ourselves
+        int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            break;
+
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#ifdef SO_INCOMING_CPU
+        if (cpu >= 0)
+            setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu));
+#endif
+
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(STREAM_IP_PORT);
+        address.sin_addr.s_addr = htonl(ifaceAddr.ip().toIPv4Address());
+
+        if (::bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0
+                && setSocketDescriptor(fd, QAbstractSocket::BoundState, QIODevice::ReadOnly))
+        {
+            ok = true;
+            enableTimestamps();
+            qDebug() << "sACNRxSocket " << QThread::currentThreadId() << ": Bound shard to IP:" << ifaceAddr.ip().toString() << "CPU:" << cpu;
+            break;
+        }
+        ::close(fd);
+    }
+
+    if (!ok)
+        qDebug() << "sACNRxSocket " << QThread::currentThreadId() << ": Failed to bind RX socket shard";
+
+    return ok;
+#else
+    Q_UNUSED(cpu);
+    return bindUnicast();
+#endif
+}
+
 sACNTxSocket::sACNTxSocket(QObject *parent) : QUdpSocket(parent)
 {
 
@@ -18,6 +18,16 @@
 
 #include <QObject>
 #include <QUdpSocket>
+#include <QHostAddress>
+#include "sacnpacket.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+// The number of datagrams a sACNRxSocket drains per call of readDatagramBatch()
+#define SACN_RX_BATCH_SIZE 32
 
 class sACNRxSocket : public QUdpSocket
 {
@@ -28,6 +38,30 @@ public:
     bool bindMulticast(quint16 universe);
     bool bindUnicast();
 
+    /**
+     * @brief bindUnicastShard binds one of several unicast sockets that share the port with
+     * SO_REUSEPORT, the kernel then spreads the incoming flows across them.
+     * Falls back to bindUnicast() where SO_REUSEPORT is not available.
+     * @param cpu steer packets handled by this CPU to the socket (SO_INCOMING_CPU), -1 for any
+     */
+    bool bindUnicastShard(int cpu);
+
+    /**
+     * @brief readDatagramBatch drains up to SACN_RX_BATCH_SIZE pending datagrams into the
+     * preallocated batch of this socket, replacing the previous batch.
+     * On Linux everything after the first datagram is fetched with a single recvmmsg() call, and
+     * each packet carries the kernel receive timestamp (SO_TIMESTAMPNS).
+     * @return the number of datagrams available through batchDatagram()
+     */
+    int readDatagramBatch();
+
+    /**
+     * @brief batchPacket
+     * @param index the slot in the batch, 0 to readDatagramBatch() - 1
+     * @return a packet of the last batch, valid until the next call of readDatagramBatch()
+     */
+    const sACNPacket &batchPacket(int index) const { return m_batch[index]; }
+
     /**
      * @brief setNetworkInterface sets the network interface used to receive sACN data
      * Must be called before any other library function to take effect!
@@ -37,6 +71,18 @@ public:
 
 private:
     static QNetworkInterface s_networkInterace;
+
+    void enableTimestamps();
+
+    bool m_multicast;
+    sACNPacketPool m_batch;
+    QHostAddress m_sender;
+#ifdef Q_OS_LINUX
+    struct mmsghdr m_batchHeaders[SACN_RX_BATCH_SIZE];
+    struct iovec m_batchVectors[SACN_RX_BATCH_SIZE];
+    struct sockaddr_in m_batchSenders[SACN_RX_BATCH_SIZE];
+    char m_batchControl[SACN_RX_BATCH_SIZE][CMSG_SPACE(sizeof(struct timespec))];
+#endif
 };
 
 class sACNTxSocket : public QUdpSocket
@@ -0,0 +1,182 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnsourcestate.h"
+#include "streamcommon.h"
+
+sACNSourceStateMachine::Transition sACNSourceStateMachine::s_table[StateCount][InputCount];
+
+struct sACNSourceStateTableBuilder
+{
+    sACNSourceStateTableBuilder()
+    {
+        for(int state = 0; state < sACNSourceStateMachine::StateCount; state++)
+            for(int input = 0; input < sACNSourceStateMachine::InputCount; input++)
+                sACNSourceStateMachine::s_table[state][input] = sACNSourceStateMachine::transitionFor(quint8(state), quint8(input));
+    }
+};
+static sACNSourceStateTableBuilder tableBuilder;
+
+quint8 sACNSourceStateMachine::packetInput(int startCode, bool terminated)
+{
+    quint8 input;
+    if(startCode == STARTCODE_DMX)
+        input = StartCodeDMX;
+    else if(startCode == STARTCODE_PRIORITY)
+        input = StartCodePriority;
+    else
+        input = StartCodeOther;
+    if(terminated)
+        input |= Terminated;
+    return input;
+}
+
+// Restarting a timer which was just given a new interval changes nothing
+static inline void resetTimer(quint8 &op)
+{
+    if(op == sACNSourceStateMachine::KeepTimer)
+        op = sACNSourceStateMachine::ResetTimer;
+}
+
+sACNSourceStateMachine::Transition sACNSourceStateMachine::transitionFor(quint8 state, quint8 input)
+{
+    Transition t;
+    t.actions = 0;
+    t.active = KeepTimer;
+    t.priorityWait = KeepTimer;
+
+    bool valid = state & Valid;
+    bool waitedForDD = state & WaitedForDD;
+    bool doingDMX = state & DoingDMX;
+    bool perChannel = state & PerChannel;
+    int startCode = input & StartCodeMask;
+    bool priorityWaitExpired = input & PriorityWaitExpired;
+    bool notify = false;
+    bool process = true;
+
+    if(input & NewSource)
+    {
+        t.active = SetOffline;
+        t.actions |= RestartSequence;
+        valid = true;
+        doingDMX = (startCode == StartCodeDMX);
+        if(input & Sampling)
+        {
+            // During the sampling period, let all packets through
+            waitedForDD = true;
+            perChannel = (startCode == StartCodePriority);
+            notify = true;
+            t.priorityWait = SetOffline;
+        }
+        else
+        {
+            // Wait for 0xDD packets before announcing it
+            waitedForDD = perChannel = false;
+            t.priorityWait = SetPriorityWait;
+        }
+        process = notify;
+    }
+    else
+    {
+        bool sequenceOk = input & SequenceOk;
+        if(!valid)
+        {
+            // This is a source which is coming back online, so we need to repeat the steps
+            // for initial source aquisition
+            t.active = SetOffline;
+            t.actions |= RestartSequence;
+            valid = true;
+            doingDMX = (startCode == StartCodeDMX);
+            perChannel = waitedForDD = false;
+            t.priorityWait = SetPriorityWait;
+            priorityWaitExpired = false;
+            // The sequence number was just taken, so it is never newer
+            sequenceOk = false;
+        }
+
+        if(input & Terminated)
+        {
+            //by setting this flag to false, 0xdd packets that may come in while the terminated data
+            //packets come in won't reset the priority_wait timer
+            waitedForDD = false;
+            if(startCode == StartCodeDMX)
+                doingDMX = false;
+
+            //"Upon receipt of a packet containing this bit set
+            //to a value of 1, a receiver shall enter network
+            //data loss condition.  Any property values in
+            //these packets shall be ignored"
+            t.active = SetHoldLastLook;
+            if(perChannel)
+                t.priorityWait = SetHoldLastLook;
+            process = false;
+        }
+        else
+        {
+            //Based on the start code, update the timers
+            if(startCode == StartCodeDMX)
+            {
+                doingDMX = true;
+                t.active = SetOffline;
+            }
+            else if(startCode == StartCodePriority && waitedForDD)
+            {
+                //The source could have stopped sending dd for a while.
+                perChannel = true;
+                resetTimer(t.priorityWait);
+                priorityWaitExpired = false;
+            }
+
+            t.actions |= CheckSequence;
+            if(!sequenceOk)
+                process = false;
+
+            //We want to wait for dd packets (sampling period tweaks aside) and notify them with
+            //the dd packet first, but we don't want to do that if we've never seen a dmx packet
+            //from the source.
+            if(!doingDMX)
+            {
+                //A source only sending 0xdd is still valid, but we don't want to let the priority
+                //timer run out
+                resetTimer(t.priorityWait);
+            }
+            else if(!waitedForDD && process)
+            {
+                if(startCode == StartCodePriority)
+                {
+                    waitedForDD = true;
+                    perChannel = true;
+                    t.priorityWait = SetOffline;
+                    notify = true;
+                }
+                else if(priorityWaitExpired)
+                {
+                    waitedForDD = true;
+                    perChannel = false;
+                    //In case the source later decides to sent 0xdd packets
+                    t.priorityWait = SetOffline;
+                    notify = true;
+                }
+                else
+                    process = false;
+            }
+        }
+    }
+
+    if(notify)
+        t.actions |= Notify;
+    if(process)
+        t.actions |= Process;
+    t.state = (valid ? Valid : 0) | (waitedForDD ? WaitedForDD : 0) |
+              (doingDMX ? DoingDMX : 0) | (perChannel ? PerChannel : 0);
+    return t;
+}
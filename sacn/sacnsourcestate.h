@@ -0,0 +1,322 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNSOURCESTATE_H
+#define SACNSOURCESTATE_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The sACNSourceStateMachine class decides what a received packet does to its source:
+ * source acquisition, network data loss and the detection of per-channel priority (0xDD).
+ * The state of a source and the relevant facts about a packet are small bit sets. receive()
+ * handles a packet with branches, every combination is also worked out once by transitionFor()
+ * into a table, which receiveTable() uses and the tests check receive() against.
+ */
+class sACNSourceStateMachine
+{
+public:
+    // The state of a source
+    enum StateFlag
+    {
+        Valid = 0x1,        // Online
+        WaitedForDD = 0x2,  // The wait for 0xDD packets is over, the source has been announced
+        DoingDMX = 0x4,     // Sending DMX data
+        PerChannel = 0x8    // Sending per-channel priority
+    };
+
+    // What is known about a packet
+    enum InputFlag
+    {
+        StartCodeDMX = 0x0,
+        StartCodePriority = 0x1,
+        StartCodeOther = 0x2,
+        StartCodeMask = 0x3,
+        Terminated = 0x4,           // The stream terminated option is set
+        PriorityWaitExpired = 0x8,  // The priority_wait timer of the source has expired
+        SequenceOk = 0x10,          // The sequence number is not out of order
+        NewSource = 0x20,           // The source was not known yet
+        Sampling = 0x40             // The listener is in its initial sampling period
+    };
+
+    // What to do with a timer of the source
+    enum TimerOp
+    {
+        KeepTimer,
+        ResetTimer,       // Restart with the current interval
+        SetPriorityWait,  // WAIT_PRIORITY
+        SetOffline,       // WAIT_OFFLINE plus the hold last look time
+        SetHoldLastLook   // The hold last look time
+    };
+
+    enum ActionFlag
+    {
+        Notify = 0x1,           // The source has been detected, or came back
+        Process = 0x2,          // Take the data of the packet
+        RestartSequence = 0x4,  // Take the sequence number as it is
+        CheckSequence = 0x8     // Count sequence errors and take the sequence number if in order
+    };
+
+    enum { StateCount = 16, InputCount = 128 };
+
+    struct Transition
+    {
+        quint8 state;        // The new state
+        quint8 actions;      // ActionFlags
+        quint8 active;       // TimerOp for the active timer
+        quint8 priorityWait; // TimerOp for the priority_wait timer
+    };
+
+    /**
+     * @brief step
+     * @return the transition of a source in state receiving a packet described by input
+     */
+    static const Transition &step(quint8 state, quint8 input) { return s_table[state][input]; }
+
+    /**
+     * @brief transitionFor works out a transition branch by branch, the table holds its results
+     */
+    static Transition transitionFor(quint8 state, quint8 input);
+
+    /**
+     * @brief sequenceOk
+     * @return false if the sequence number is older than the last one, a jump back of more
+     * than 20 is taken as a restart of the source
+     */
+    static bool sequenceOk(quint8 sequence, quint8 lastSequence) {
+        qint8 result = qint8(sequence) - qint8(lastSequence);
+        return !(result <= 0 && result > -20);
+    }
+
+    /**
+     * @brief The Timeouts struct holds the intervals the TimerOps set, in ms
+     */
+    struct Timeouts
+    {
+        int priorityWait;   // SetPriorityWait
+        int offline;        // SetOffline
+        int holdLastLook;   // SetHoldLastLook
+    };
+
+    /**
+     * @brief packetInput
+     * @return the InputFlags which only depend on the packet
+     */
+    static quint8 packetInput(int startCode, bool terminated);
+
+    /**
+     * @brief receive takes a packet into a source, updating its state, timers and sequence
+     * counters. This is the code sACNListener runs: plain branches, which are faster on the
+     * steady stream of in-sequence packets than looking the transition up. Source is sACNSource,
+     * or a model of it in the tests.
+     * @param found false for the first packet of a source, which must be freshly recycled
+     * @param input from packetInput()
+     * @return the Notify and Process ActionFlags
+     */
+    template<typename Source>
+    static quint8 receive(Source &source, bool found, quint8 input, quint8 sequence,
+                          bool sampling, const Timeouts &timeouts);
+
+    /**
+     * @brief receiveTable does what receive() does through step(), the table every input
+     * combination is worked out in. The tests check receive() against it.
+     */
+    template<typename Source>
+    static quint8 receiveTable(Source &source, bool found, quint8 input, quint8 sequence,
+                               bool sampling, const Timeouts &timeouts);
+
+private:
+    template<typename Timer>
+    static void applyTimerOp(Timer &timer, quint8 op, const Timeouts &timeouts);
+
+    static Transition s_table[StateCount][InputCount];
+    friend struct sACNSourceStateTableBuilder;
+};
+
+template<typename Timer>
+inline void sACNSourceStateMachine::applyTimerOp(Timer &timer, quint8 op, const Timeouts &timeouts)
+{
+    switch(op)
+    {
+    case ResetTimer:
+        timer.Reset();
+        break;
+    case SetPriorityWait:
+        timer.SetInterval(timeouts.priorityWait);
+        break;
+    case SetOffline:
+        timer.SetInterval(timeouts.offline);
+        break;
+    case SetHoldLastLook:
+        //We factor in the hold last look time here, rather than 0
+        timer.SetInterval(timeouts.holdLastLook);
+        break;
+    }
+}
+
+template<typename Source>
+inline quint8 sACNSourceStateMachine::receive(Source &source, bool found, quint8 input, quint8 sequence,
+        bool sampling, const Timeouts &timeouts)
+{
+    int startCode = input & StartCodeMask;
+    bool doingDMX = (startCode == StartCodeDMX);
+    if(!found)
+    {
+        source.active.SetInterval(timeouts.offline);
+        source.lastseq = sequence;
+        source.stats.countSequence(1);
+        if(sampling)
+        {
+            //During the sampling period, let all packets through
+            source.priority_wait.SetInterval(timeouts.offline);
+            source.setState(Valid | WaitedForDD | (doingDMX ? DoingDMX : 0)
+                            | (startCode == StartCodePriority ? PerChannel : 0));
+            return Notify | Process;
+        }
+        // Wait for 0xDD packets before announcing it
+        source.priority_wait.SetInterval(timeouts.priorityWait);
+        source.setState(Valid | (doingDMX ? DoingDMX : 0));
+        return 0;
+    }
+
+    quint8 state = source.state;
+    bool comingBack = !(state & Valid);
+    if(comingBack)
+    {
+        //This is a source which is coming back online, so we need to repeat the steps
+        //for initial source aquisition
+        source.active.SetInterval(timeouts.offline);
+        source.lastseq = sequence;
+        source.priority_wait.SetInterval(timeouts.priorityWait);
+        state = Valid | (doingDMX ? DoingDMX : 0);
+    }
+
+    if(input & Terminated)
+    {
+        state &= ~WaitedForDD;
+        if(startCode == StartCodeDMX)
+            state &= ~DoingDMX;
+        source.active.SetInterval(timeouts.holdLastLook);
+        if(state & PerChannel)
+            source.priority_wait.SetInterval(timeouts.holdLastLook);
+        if(comingBack)
+            source.stats.countSequence(1);
+        source.setState(state);
+        return 0;
+    }
+
+    if(startCode == StartCodeDMX)
+    {
+        state |= DoingDMX;
+        source.active.SetInterval(timeouts.offline);
+    }
+    else if(startCode == StartCodePriority && (state & WaitedForDD))
+    {
+        state |= PerChannel;
+        source.priority_wait.Reset();
+    }
+
+    //Validate the sequence number, updating the stored one. The two's complement math is to
+    //handle rollover. A negative number means we got an "old" one, but we assume that anything
+    //really old is possibly due the device having rebooted and starting the sequence over.
+    quint8 actions = Process;
+    qint8 result = qint8(sequence) - qint8(source.lastseq);
+    source.stats.countSequence(result);
+    if(result!=1)
+        source.jumps++;
+    if((result <= 0) && (result > -20))
+    {
+        source.seqErr++;
+        actions = 0;
+    }
+    else
+        source.lastseq = sequence;
+
+    if(!(state & DoingDMX))
+        source.priority_wait.Reset();
+    else if(!(state & WaitedForDD) && actions)
+    {
+        if(startCode == StartCodePriority)
+        {
+            state |= WaitedForDD | PerChannel;
+            source.priority_wait.SetInterval(timeouts.offline);
+            actions |= Notify;
+        }
+        else if(source.priority_wait.Expired())
+        {
+            // No 0xdd packets within WAIT_PRIORITY, announce it without them
+            state = (state | WaitedForDD) & ~PerChannel;
+            source.priority_wait.SetInterval(timeouts.offline);
+            actions |= Notify;
+        }
+        else
+            actions = 0;
+    }
+
+    source.setState(state);
+    return actions;
+}
+
+template<typename Source>
+inline quint8 sACNSourceStateMachine::receiveTable(Source &source, bool found, quint8 input,
+         quint8 sequence, bool sampling, const Timeouts &timeouts)
+{
+    quint8 state = 0;
+    if(found)
+    {
+        state = source.state;
+        //The two's complement math is to handle rollover. A negative number means
+        //we got an "old" one, but we assume that anything really old is possibly
+        //due the device having rebooted and starting the sequence over.
+        if(sequenceOk(sequence, quint8(source.lastseq)))
+            input |= SequenceOk;
+        // Only needed while waiting for 0xdd packets
+        if(!(state & WaitedForDD) && source.priority_wait.Expired())
+            input |= PriorityWaitExpired;
+    }
+    else
+    {
+        input |= NewSource;
+        //If we are in the sampling period, let all packets through
+        if(sampling)
+            input |= Sampling;
+    }
+
+    const Transition &transition = step(state, input);
+    applyTimerOp(source.active, transition.active, timeouts);
+    applyTimerOp(source.priority_wait, transition.priorityWait, timeouts);
+
+    if(transition.actions & RestartSequence)
+    {
+        source.lastseq = sequence;
+        // A source coming back also has its sequence checked, which counts the packet
+        if(!(transition.actions & CheckSequence))
+            source.stats.countSequence(1);
+    }
+    if(transition.actions & CheckSequence)
+    {
+        //Validate the sequence number, updating the stored one
+        qint8 result = qint8(sequence) - qint8(source.lastseq);
+        source.stats.countSequence(result);
+        if(result!=1)
+            source.jumps++;
+        if((result <= 0) && (result > -20))
+            source.seqErr++;
+        else
+            source.lastseq = sequence;
+    }
+
+    source.setState(transition.state);
+    return transition.actions & (Notify | Process);
+}
+
+#endif // SACNSOURCESTATE_H
@@ -0,0 +1,57 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnsourcestats.h"
+
+#include <QtAlgorithms>
+#include <string.h>
+
+// Sequence numbers this far behind mean the source restarted, as in sACNListener
+#define SEQUENCE_RESTART (-20)
+
+sACNSourceStats::sACNSourceStats()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+void sACNSourceStats::countSequence(int delta)
+{
+    packets++;
+    if(delta > 0)
+    {
+        // The gap is lost until its packets turn up late
+        lost += delta - 1;
+    }
+    else if(delta == 0)
+        duplicates++;
+    else if(delta > SEQUENCE_RESTART)
+    {
+        reordered++;
+        if(lost)
+            lost--;
+    }
+}
+
+void sACNSourceStats::countJitter(qint64 variation)
+{
+    // Bucket by the number of bits of the variation in us, rounded down to 1024ns
+    quint64 us = quint64(qAbs(variation)) >> 10;
+    int bucket = us ? 64 - qCountLeadingZeroBits(us) : 0;
+    jitter[qMin<int>(bucket, JitterBuckets - 1)]++;
+}
+
+double sACNSourceStats::lossRate() const
+{
+    // Late packets were received, only duplicates do not count
+    quint64 expected = packets - duplicates + lost;
+    return expected ? double(lost) / double(expected) : 0.0;
+}
@@ -0,0 +1,70 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNSOURCESTATS_H
+#define SACNSOURCESTATS_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The sACNSourceStats struct describes the network quality of one source, counted since
+ * the source was found. Read it with sACNListener::sourceStats().
+ */
+struct sACNSourceStats
+{
+    enum {
+        // Bucket 0 of the jitter histogram counts variations below 1us, bucket n those
+        // from 2^(n-1) to 2^n us and the last one everything above
+        JitterBuckets = 16
+    };
+
+    sACNSourceStats();
+
+    /**
+     * @brief packets the number of packets received, whatever their sequence number
+     */
+    quint64 packets;
+    /**
+     * @brief lost the number of packets skipped by the sequence numbers and not received later
+     */
+    quint64 lost;
+    /**
+     * @brief reordered the number of packets received after one with a higher sequence number
+     */
+    quint64 reordered;
+    /**
+     * @brief duplicates the number of packets repeating the last sequence number
+     */
+    quint64 duplicates;
+    /**
+     * @brief jitter histogram of the variation of the time between packets, see JitterBuckets
+     */
+    quint64 jitter[JitterBuckets];
+
+    /**
+     * @brief countSequence counts a packet
+     * @param delta its sequence number minus the highest one received before, 1 if there is none
+     */
+    void countSequence(int delta);
+    /**
+     * @brief countJitter counts a variation of the time between packets
+     * @param variation in ns
+     */
+    void countJitter(qint64 variation);
+    /**
+     * @brief lossRate
+     * @return the fraction of packets lost, 0 to 1
+     */
+    double lossRate() const;
+};
+
+#endif // SACNSOURCESTATS_H
@@ -0,0 +1,136 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnsourcetable.h"
+
+#include <string.h>
+
+// The initial number of entries, must be a power of two
+#define INITIAL_CAPACITY 16
+
+sACNSourceTable::sACNSourceTable() :
+    m_entries(INITIAL_CAPACITY),
+    m_mask(INITIAL_CAPACITY - 1),
+    m_count(0)
+{
+    for(std::vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        it->slot = -1;
+}
+
+sACNSourceTable::Key sACNSourceTable::makeKey(const CID &cid)
+{
+    uint1 buffer[CID::CIDBYTES];
+    cid.Pack(buffer);
+
+    Key key;
+    memcpy(&key.high, buffer, sizeof(key.high));
+    memcpy(&key.low, buffer + sizeof(key.high), sizeof(key.low));
+    return key;
+}
+
+quint32 sACNSourceTable::hash(const Key &key)
+{
+    // Not every vendor uses random UUIDs, so mix all bits (MurmurHash3 finalizer)
+    quint64 h = key.high ^ (key.low * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return quint32(h);
+}
+
+int sACNSourceTable::findIndex(const Key &key) const
+{
+    // The table is never more than half full, so this always ends on an empty entry
+    quint32 index = hash(key) & m_mask;
+    while(m_entries[index].slot >= 0)
+    {
+        if(m_entries[index].key == key)
+            return int(index);
+        index = (index + 1) & m_mask;
+    }
+    return -int(index) - 1;
+}
+
+int sACNSourceTable::find(const CID &cid) const
+{
+    int index = findIndex(makeKey(cid));
+    return (index >= 0) ? m_entries[index].slot : -1;
+}
+
+void sACNSourceTable::insert(const CID &cid, int slot)
+{
+    if(2 * (m_count + 1) > int(m_entries.size()))
+        grow();
+
+    Key key = makeKey(cid);
+    int index = findIndex(key);
+    if(index >= 0)
+    {
+        m_entries[index].slot = slot;
+        return;
+    }
+
+    index = -index - 1;
+    m_entries[index].key = key;
+    m_entries[index].slot = slot;
+    m_count++;
+}
+
+void sACNSourceTable::remove(const CID &cid)
+{
+    int found = findIndex(makeKey(cid));
+    if(found < 0)
+        return;
+
+    // Backward shift deletion: move later entries of the probe sequence into the gap,
+    // so that lookups never need tombstones
+    quint32 gap = quint32(found);
+    quint32 index = gap;
+    for(;;)
+    {
+        index = (index + 1) & m_mask;
+        if(m_entries[index].slot < 0)
+            break;
+        quint32 home = hash(m_entries[index].key) & m_mask;
+        // Only move the entry if its home is not between the gap and its position
+        if(((index - home) & m_mask) >= ((index - gap) & m_mask))
+        {
+            m_entries[gap] = m_entries[index];
+            gap = index;
+        }
+    }
+    m_entries[gap].slot = -1;
+    m_count--;
+}
+
+void sACNSourceTable::grow()
+{
+    std::vector<Entry> old;
+    old.swap(m_entries);
+
+    m_entries.resize(old.size() * 2);
+    m_mask = quint32(m_entries.size() - 1);
+    for(std::vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        it->slot = -1;
+
+    for(std::vector<Entry>::const_iterator it = old.begin(); it != old.end(); ++it)
+    {
+        if(it->slot < 0)
+            continue;
+        quint32 index = hash(it->key) & m_mask;
+        while(m_entries[index].slot >= 0)
+            index = (index + 1) & m_mask;
+        m_entries[index] = *it;
+    }
+}
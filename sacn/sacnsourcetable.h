@@ -0,0 +1,75 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNSOURCETABLE_H
+#define SACNSOURCETABLE_H
+
+#include <QtGlobal>
+#include <vector>
+#include "ACNShare/deftypes.h"
+#include "ACNShare/CID.h"
+
+/**
+ * @brief The sACNSourceTable class maps the CID of a source to its slot in the listener.
+ * It is a flat open addressing hash table with linear probing, keyed by the 128 bit CID,
+ * so a lookup costs one hash and usually a single compare.
+ */
+class sACNSourceTable
+{
+public:
+    sACNSourceTable();
+
+    /**
+     * @brief find
+     * @return the slot of the source with this CID, -1 if there is none
+     */
+    int find(const CID &cid) const;
+
+    /**
+     * @brief insert adds a CID that is not in the table yet
+     */
+    void insert(const CID &cid, int slot);
+
+    /**
+     * @brief remove removes a CID, if present
+     */
+    void remove(const CID &cid);
+
+    int count() const { return m_count; }
+
+private:
+    // Places keys at chosen entries and checks the probe sequences
+    friend class TestSourceTable;
+
+    struct Key
+    {
+        quint64 high;
+        quint64 low;
+        bool operator==(const Key &other) const { return high == other.high && low == other.low; }
+    };
+    struct Entry
+    {
+        Key key;
+        int slot; // -1 if the entry is empty
+    };
+
+    static Key makeKey(const CID &cid);
+    static quint32 hash(const Key &key);
+    int findIndex(const Key &key) const;
+    void grow();
+
+    std::vector<Entry> m_entries;
+    quint32 m_mask;
+    int m_count;
+};
+
+#endif // SACNSOURCETABLE_H
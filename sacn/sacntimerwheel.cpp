@@ -0,0 +1,173 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacntimerwheel.h"
+
+#include <QtAlgorithms>
+
+sACNTimerWheel::sACNTimerWheel(int capacity, quint32 now) :
+    m_now(now),
+    m_deadline(capacity, 0),
+    m_due(capacity, 0),
+    m_bucket(capacity, -1),
+    m_next(capacity, -1),
+    m_prev(capacity, -1)
+{
+    for(int i = 0; i < Levels * Slots; i++)
+        m_head[i] = -1;
+    for(int i = 0; i < Levels; i++)
+        m_occupied[i] = 0;
+}
+
+bool sACNTimerWheel::schedule(int id, quint32 deadline)
+{
+    m_deadline[id] = deadline;
+    // A later deadline is picked up when the current bucket comes up
+    if(isScheduled(id) && qint32(deadline - m_due[id]) >= 0)
+        return false;
+    if(isScheduled(id))
+        unlink(id);
+    insert(id, deadline);
+    return true;
+}
+
+void sACNTimerWheel::cancel(int id)
+{
+    if(isScheduled(id))
+        unlink(id);
+}
+
+void sACNTimerWheel::insert(int id, quint32 deadline)
+{
+    qint32 delta = qint32(deadline - m_now);
+    if(delta < 0)
+        deadline = m_now;
+    else if(delta > MaxDelta)
+        deadline = m_now + MaxDelta;
+
+    // The lowest level on which the deadline is within the current window of the level above
+    int level = 0;
+    while(level < Levels - 1 && (deadline >> (LevelBits * (level + 1))) != (m_now >> (LevelBits * (level + 1))))
+        level++;
+    int slot = (deadline >> (LevelBits * level)) & (Slots - 1);
+    int bucket = level * Slots + slot;
+
+    m_due[id] = (deadline >> (LevelBits * level)) << (LevelBits * level);
+    m_bucket[id] = bucket;
+    m_prev[id] = -1;
+    m_next[id] = m_head[bucket];
+    if(m_head[bucket] >= 0)
+        m_prev[m_head[bucket]] = id;
+    m_head[bucket] = id;
+    m_occupied[level] |= Q_UINT64_C(1) << slot;
+}
+
+void sACNTimerWheel::unlink(int id)
+{
+    int bucket = m_bucket[id];
+    if(m_prev[id] >= 0)
+        m_next[m_prev[id]] = m_next[id];
+    else
+        m_head[bucket] = m_next[id];
+    if(m_next[id] >= 0)
+        m_prev[m_next[id]] = m_prev[id];
+    if(m_head[bucket] < 0)
+        m_occupied[bucket / Slots] &= ~(Q_UINT64_C(1) << (bucket % Slots));
+    m_bucket[id] = -1;
+}
+
+int sACNTimerWheel::takeBucket(int bucket)
+{
+    int first = m_head[bucket];
+    for(int id = first; id >= 0; id = m_next[id])
+        m_bucket[id] = -1;
+    m_head[bucket] = -1;
+    m_occupied[bucket / Slots] &= ~(Q_UINT64_C(1) << (bucket % Slots));
+    return first;
+}
+
+bool sACNTimerWheel::nextBucketTick(quint32 &tick) const
+{
+    bool found = false;
+    for(int level = 0; level < Levels; level++)
+    {
+        if(!m_occupied[level])
+            continue;
+        int shift = LevelBits * level;
+        int current = (m_now >> shift) & (Slots - 1);
+        quint32 window = (m_now >> (shift + LevelBits)) << (shift + LevelBits);
+        quint64 ahead = m_occupied[level] & (~Q_UINT64_C(0) << current);
+        quint32 candidate;
+        if(ahead)
+            candidate = window + (quint32(qCountTrailingZeroBits(ahead)) << shift);
+        else
+        {
+            // Only the top level wraps around into the next window
+            candidate = window + (quint32(Slots) << shift) + (quint32(qCountTrailingZeroBits(m_occupied[level])) << shift);
+        }
+        if(!found || qint32(candidate - tick) < 0)
+            tick = candidate;
+        found = true;
+    }
+    return found;
+}
+
+int sACNTimerWheel::advance(quint32 now, int *expired)
+{
+    int count = 0;
+    quint32 tick;
+    while(nextBucketTick(tick) && qint32(tick - now) <= 0)
+    {
+        m_now = tick;
+
+        // Entering a new window of a level moves its bucket down, top level first
+        for(int level = Levels - 1; level > 0; level--)
+        {
+            int shift = LevelBits * level;
+            if(m_now & ((quint32(1) << shift) - 1))
+                continue;
+            int id = takeBucket(level * Slots + ((m_now >> shift) & (Slots - 1)));
+            while(id >= 0)
+            {
+                int next = m_next[id];
+                insert(id, m_deadline[id]);
+                id = next;
+            }
+        }
+
+        int id = takeBucket(m_now & (Slots - 1));
+        while(id >= 0)
+        {
+            int next = m_next[id];
+            if(qint32(m_deadline[id] - m_now) <= 0)
+                expired[count++] = id;
+            else
+                insert(id, m_deadline[id]);
+            id = next;
+        }
+
+        m_now = tick + 1;
+    }
+    // Stay on now, deadlines scheduled for now or earlier are then run by the next call
+    if(qint32(m_now - now) <= 1)
+        m_now = now;
+    return count;
+}
+
+int sACNTimerWheel::nextTick(quint32 now) const
+{
+    quint32 tick;
+    if(!nextBucketTick(tick))
+        return -1;
+    qint32 delta = qint32(tick - now);
+    return delta > 0 ? delta : 0;
+}
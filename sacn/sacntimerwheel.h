@@ -0,0 +1,88 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNTIMERWHEEL_H
+#define SACNTIMERWHEEL_H
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief The sACNTimerWheel class keeps one deadline per id, in ms tocks (see Tock_GetTock()).
+ * Deadlines are sorted into four levels of 64 buckets, 1ms, 64ms, 4s and 4.4 minutes wide,
+ * so advancing only looks at the buckets which are due.
+ *
+ * Moving a deadline later does not touch the wheel: the id stays in its earlier bucket and is
+ * moved when that bucket comes up. This keeps schedule() cheap for sources which push their
+ * timeouts back with every packet.
+ */
+class sACNTimerWheel
+{
+public:
+    /**
+     * @param capacity ids are 0 to capacity - 1
+     * @param now the current tock
+     */
+    sACNTimerWheel(int capacity, quint32 now);
+
+    /**
+     * @brief schedule sets the deadline of an id, replacing any earlier one
+     * @return true if the next tick of the wheel may have moved earlier
+     */
+    bool schedule(int id, quint32 deadline);
+    void cancel(int id);
+    bool isScheduled(int id) const { return m_bucket[id] >= 0; }
+
+    /**
+     * @brief advance runs the wheel up to now
+     * @param expired receives the ids whose deadline has been reached, they are no longer scheduled
+     * @return the number of ids written to expired, at most capacity
+     */
+    int advance(quint32 now, int *expired);
+
+    /**
+     * @brief nextTick
+     * @return the ms from now until advance() has work to do, -1 if nothing is scheduled.
+     * Deadlines which were moved later can make this earlier than the next real deadline.
+     */
+    int nextTick(quint32 now) const;
+
+private:
+    enum {
+        Levels = 4,
+        LevelBits = 6,
+        Slots = 1 << LevelBits,
+        // The longest deadline placed directly, later ones are placed here and moved on
+        MaxDelta = (1 << (Levels * LevelBits)) - (1 << ((Levels - 1) * LevelBits))
+    };
+    void insert(int id, quint32 deadline);
+    void unlink(int id);
+    // Removes all ids from a bucket, returning the first of them
+    int takeBucket(int bucket);
+    // The tick the next bucket with entries comes up, false if the wheel is empty
+    bool nextBucketTick(quint32 &tick) const;
+
+    // The next tick to be processed, or the last one if advance() may be called again for it
+    quint32 m_now;
+    // Per id: its deadline, the tick its bucket comes up, its bucket or -1,
+    // and its neighbours in the bucket
+    std::vector<quint32> m_deadline;
+    std::vector<quint32> m_due;
+    std::vector<int> m_bucket;
+    std::vector<int> m_next;
+    std::vector<int> m_prev;
+    // The first id in each bucket, level * Slots + slot, and a bit per bucket with entries
+    int m_head[Levels * Slots];
+    quint64 m_occupied[Levels];
+};
+
+#endif // SACNTIMERWHEEL_H
@@ -0,0 +1,76 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sacnunicastreceiver.h"
+
+#include "streamingacn.h"
+#include "sacnlistener.h"
+#include "streamcommon.h"
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+
+sACNUnicastReceiver::sACNUnicastReceiver(int shard, int cpu, QObject *parent) : QObject(parent),
+    m_shard(shard),
+    m_cpu(cpu),
+    m_socket(nullptr)
+{
+
+}
+
+sACNUnicastReceiver::~sACNUnicastReceiver()
+{
+    delete m_socket;
+}
+
+void sACNUnicastReceiver::startReception()
+{
+    qDebug() << "sACNUnicastReceiver" << QThread::currentThreadId() << ": Starting shard" << m_shard;
+
+    m_socket = new sACNRxSocket();
+    bool ok = (m_shard < 0) ? m_socket->bindUnicast() : m_socket->bindUnicastShard(m_cpu);
+    if (ok) {
+        connect(m_socket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()), Qt::DirectConnection);
+    } else {
+        // Failed to bind
+        delete m_socket;
+        m_socket = nullptr;
+    }
+}
+
+void sACNUnicastReceiver::readPendingDatagrams()
+{
+    sACNManager *manager = sACNManager::getInstance();
+
+    // The listeners on this thread which processed packets of the batch, merged once it is done
+    sACNListener *processed[SACN_RX_BATCH_SIZE];
+    int processedCount = 0;
+
+    int count;
+    do
+    {
+        count = m_socket->readDatagramBatch();
+        for (int i = 0; i < count; i++)
+        {
+            const sACNPacket &packet = m_socket->batchPacket(i);
+            uint2 universe;
+            sACNListener *listener = nullptr;
+            if (packet.length >= 0 && GetStreamUniverse(packet.data, packet.length, universe))
+                manager->routePacket(packet, universe, &listener);
+            if (listener && std::find(processed, processed + processedCount, listener) == processed + processedCount)
+                processed[processedCount++] = listener;
+        }
+        for (int i = 0; i < processedCount; i++)
+            processed[i]->flushMerge();
+        processedCount = 0;
+    } while (count == SACN_RX_BATCH_SIZE);
+}
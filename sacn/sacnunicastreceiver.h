@@ -0,0 +1,47 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SACNUNICASTRECEIVER_H
+#define SACNUNICASTRECEIVER_H
+
+#include <QObject>
+#include "sacnsocket.h"
+
+/**
+ * @brief The sACNUnicastReceiver class owns a unicast socket of the process, either the only one
+ * or one shard of a SO_REUSEPORT group with one shard per receive thread.
+ * It reads only the universe of each packet and hands the packet to the listener of that
+ * universe through sACNManager::routePacket().
+ * The class should not be instantiated directly, sACNManager creates it with the first listener.
+ */
+class sACNUnicastReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param shard the index of this receiver if several share the port with SO_REUSEPORT, -1 if it is the only one
+     * @param cpu the CPU whose packets this shard should get, -1 for any
+     */
+    explicit sACNUnicastReceiver(int shard = -1, int cpu = -1, QObject *parent = nullptr);
+    virtual ~sACNUnicastReceiver();
+
+public slots:
+    void startReception();
+private slots:
+    void readPendingDatagrams();
+private:
+    int m_shard;
+    int m_cpu;
+    sACNRxSocket *m_socket;
+};
+
+#endif // SACNUNICASTRECEIVER_H
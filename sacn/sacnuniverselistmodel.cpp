@@ -77,6 +77,9 @@ void sACNUniverseListModel::setStartUniverse(int start)
         // Add the existing sources
         for(int i=0; i<m_listeners.back()->sourceCount(); i++)
         {
+            // Forgotten sources wait to be released or reused
+            if(m_listeners.back()->source(i)->slot_state != sACNSource::SlotInUse)
+                continue;
             modelindex_locker.unlock();
             sourceOnline(m_listeners.back()->source(i));
             modelindex_locker.relock();
@@ -85,6 +88,7 @@ void sACNUniverseListModel::setStartUniverse(int start)
         connect(m_listeners.back().data(), SIGNAL(sourceFound(sACNSource*)), this, SLOT(sourceOnline(sACNSource*)));
         connect(m_listeners.back().data(), SIGNAL(sourceLost(sACNSource*)), this, SLOT(sourceOffline(sACNSource*)));
         connect(m_listeners.back().data(), SIGNAL(sourceChanged(sACNSource*)), this, SLOT(sourceChanged(sACNSource*)));
+        connect(m_listeners.back().data(), SIGNAL(sourceRemoved(sACNSource*)), this, SLOT(sourceRemoved(sACNSource*)));
     }
 
     endResetModel();
@@ -262,6 +266,15 @@ void sACNUniverseListModel::sourceOffline(sACNSource *source)
     endRemoveRows();
 }
 
+void sACNUniverseListModel::sourceRemoved(sACNSource *source)
+{
+    // Offline sources have already been removed and no copy refers to the source,
+    // so the listener can reuse it
+    sACNListener *listener = qobject_cast<sACNListener *>(sender());
+    if(listener)
+        listener->releaseSource(source);
+}
+
 int sACNUniverseListModel::indexToUniverse(const QModelIndex &index)
 {
     QReadLocker locker(&rwlock_ModelIndex);
@@ -68,6 +68,7 @@ public slots:
     void sourceOnline(sACNSource *source);
     void sourceChanged(sACNSource *source);
     void sourceOffline(sACNSource *source);
+    void sourceRemoved(sACNSource *source);
 
 private:
     mutable QReadWriteLock rwlock_ModelIndex;
@@ -273,11 +273,11 @@ void SetStreamHeaderSequence(uint1* pbuf, uint1 seq, bool draft)
  * source_space must be of size SOURCE_NAME_SPACE.
  * pdata is the offset into the buffer where the data is stored
  */
-bool ValidateStreamHeader(uint1* pbuf, uint buflen, CID &source_cid, 
+bool ValidateStreamHeader(const uint1* pbuf, uint buflen, CID &source_cid, 
 			  char* source_space, uint1 &priority, 
 			  uint1 &start_code, uint2 &reserved, 
 			  uint1 &sequence, uint1 &options, uint2 &universe,
-			  uint2 &slot_count, uint1* &pdata)
+			  uint2 &slot_count, const uint1* &pdata)
 {
   if(!pbuf)
      return false;
@@ -308,11 +308,11 @@ bool ValidateStreamHeader(uint1* pbuf, uint buflen, CID &source_cid,
  * helper function that does the actual validation of a header
  * that carries the post-ratification root vector
  */
-bool VerifyStreamHeader(uint1* pbuf, uint buflen, CID &source_cid, 
+bool VerifyStreamHeader(const uint1* pbuf, uint buflen, CID &source_cid, 
 			char* source_space, uint1 &priority, 
 			uint1 &start_code, uint2 &reserved, uint1 &sequence, 
 			uint1 &options, uint2 &universe,
-			uint2 &slot_count, uint1* &pdata)
+			uint2 &slot_count, const uint1* &pdata)
 {
   if(!pbuf)
      return false;
@@ -363,7 +363,7 @@ bool VerifyStreamHeader(uint1* pbuf, uint buflen, CID &source_cid,
   /* Init the parameters */
   source_cid.Unpack(pbuf + CID_ADDR);
   
-  strncpy(source_space, (char*)(pbuf + SOURCE_NAME_ADDR), SOURCE_NAME_SIZE);
+  strncpy(source_space, (const char*)(pbuf + SOURCE_NAME_ADDR), SOURCE_NAME_SIZE);
   source_space[SOURCE_NAME_SIZE-1] = '\0';
   priority = UpackB1(pbuf + PRIORITY_ADDR);
   start_code = UpackB1(pbuf + START_CODE_ADDR);
@@ -387,11 +387,11 @@ bool VerifyStreamHeader(uint1* pbuf, uint buflen, CID &source_cid,
  * This function is included to support legacy code from before 
  * ratification of the standard.
  */
-bool VerifyStreamHeaderForDraft(uint1* pbuf, uint buflen, CID &source_cid, 
+bool VerifyStreamHeaderForDraft(const uint1* pbuf, uint buflen, CID &source_cid, 
 				char* source_space, uint1 &priority, 
 				uint1 &start_code, uint1 &sequence, 
 				uint2 &universe, uint2 &slot_count, 
-				uint1* &pdata)
+				const uint1* &pdata)
 {
   if(!pbuf)
      return false;
@@ -437,7 +437,7 @@ bool VerifyStreamHeaderForDraft(uint1* pbuf, uint buflen, CID &source_cid,
   /* Init the parameters */
   source_cid.Unpack(pbuf + CID_ADDR);
   
-  strncpy(source_space, (char*)(pbuf + SOURCE_NAME_ADDR), 
+  strncpy(source_space, (const char*)(pbuf + SOURCE_NAME_ADDR), 
 	  DRAFT_SOURCE_NAME_SIZE);
   source_space[DRAFT_SOURCE_NAME_SIZE-1] = '\0';
   priority = UpackB1(pbuf + DRAFT_PRIORITY_ADDR);
@@ -456,6 +456,34 @@ bool VerifyStreamHeaderForDraft(uint1* pbuf, uint buflen, CID &source_cid,
   return true;
 }
 
+/*
+ * Given a buffer, read just the universe of a packet, without validating
+ * the rest of the header.  Returns false if the buffer is too short or
+ * doesn't carry a known root vector.
+ */
+bool GetStreamUniverse(const uint1* pbuf, uint buflen, uint2 &universe)
+{
+  if(!pbuf || buflen < DRAFT_STREAM_HEADER_SIZE)
+     return false;
+
+  int root_vector = UpackB4(pbuf + ROOT_VECTOR_ADDR);
+
+  if(root_vector == ROOT_VECTOR && buflen >= STREAM_HEADER_SIZE)
+  {
+      universe = UpackB2(pbuf + UNIVERSE_ADDR);
+      return true;
+  }
+  else if(root_vector == DRAFT_ROOT_VECTOR)
+  {
+      universe = UpackB2(pbuf + DRAFT_UNIVERSE_ADDR);
+      return true;
+  }
+  else
+  {
+      return false;
+  }
+}
+
 /* 
  * toggles the preview_data bit of the options field to either 1 or 0
  */
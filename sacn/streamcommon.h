@@ -166,32 +166,39 @@ void SetStreamHeaderSequence(uint1* pbuf, uint1 seq, bool draft);
  * source_space must be of size SOURCE_NAME_SPACE.
  * pdata is the offset into the buffer where the data is stored
  */
-bool ValidateStreamHeader(uint1* pbuf, uint buflen, CID &source_cid, 
+bool ValidateStreamHeader(const uint1* pbuf, uint buflen, CID &source_cid, 
 			  char* source_space, uint1 &priority, 
 			  uint1 &start_code, uint2 &reserved, uint1 &sequence,
 			  uint1 &options, uint2 &universe,
-			  uint2 &slot_count, uint1* &pdata);
+			  uint2 &slot_count, const uint1* &pdata);
 
 /*
  * helper function that does the actual validation of a header
  * that carries the post-ratification root vector
  */
-bool VerifyStreamHeader(uint1* pbuf, uint buflen, CID &source_cid, 
+bool VerifyStreamHeader(const uint1* pbuf, uint buflen, CID &source_cid, 
 			char* source_space, uint1 &priority, 
 			uint1 &start_code, uint2 &reserved, uint1 &sequence, 
 			uint1 &options, uint2 &universe,
- 			uint2 &slot_count, uint1* &pdata);
+ 			uint2 &slot_count, const uint1* &pdata);
 /*
  * helper function that does the actual validation of a header
  * that carries the early draft's root vector
  * This function is included to support legacy code from before 
  * ratification of the standard.
  */
-bool VerifyStreamHeaderForDraft(uint1* pbuf, uint buflen, CID &source_cid, 
+bool VerifyStreamHeaderForDraft(const uint1* pbuf, uint buflen, CID &source_cid, 
 				char* source_space, uint1 &priority, 
 				uint1 &start_code, uint1 &sequence, 
 				uint2 &universe, uint2 &slot_count, 
-				uint1* &pdata);
+				const uint1* &pdata);
+
+/*
+ * Given a buffer, read just the universe of a packet, without validating
+ * the rest of the header.  Returns false if the buffer is too short or
+ * doesn't carry a known root vector.
+ */
+bool GetStreamUniverse(const uint1* pbuf, uint buflen, uint2 &universe);
 
 /* 
  * toggles the preview_data bit of the options field to either 1 or 0
@@ -38,14 +38,50 @@
 #include "streamingacn.h"
 
 #include "sacnlistener.h"
+#include "sacnunicastreceiver.h"
 
 #include <QCoreApplication>
 #include <QThread>
 #include <QSharedPointer>
 #include <QMessageBox>
+#include <string.h>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief The sACNReceiveThread class is a receive worker, optionally pinned to one core
+ */
+class sACNReceiveThread : public QThread
+{
+public:
+    explicit sACNReceiveThread(int core) : m_core(core) {}
+protected:
+    virtual void run()
+    {
+#ifdef Q_OS_LINUX
+        if(m_core >= 0)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(m_core, &cpus);
+            if(pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+                qDebug() << objectName() << ": Unable to pin to core" << m_core;
+        }
+#endif
+        exec();
+    }
+private:
+    int m_core;
+};
 
 sACNSource::sACNSource()
 {
+    slot = -1;
+    slot_state = SlotInUse;
+    state = 0;
     src_valid = false;
     lastseq = 0;
     waited_for_dd = false;
@@ -56,11 +92,59 @@ sACNSource::sACNSource()
     std::fill(level_array, level_array + sizeof(level_array), 0);
     std::fill(priority_array, priority_array + sizeof(priority_array), 0);
     priority = 0;
+    raw_name[0] = '\0';
     fpsTimer.start();
     fpsCounter = 0;
     fps = 0;
     seqErr = 0;
     jumps = 0;
+    last_arrival = 0;
+    last_interval = 0;
+    jitter = 0;
+    processing_delay = 0;
+}
+
+void sACNSource::setState(quint8 newState)
+{
+    state = newState;
+    src_valid = newState & sACNSourceStateMachine::Valid;
+    waited_for_dd = newState & sACNSourceStateMachine::WaitedForDD;
+    doing_dmx = newState & sACNSourceStateMachine::DoingDMX;
+    doing_per_channel = newState & sACNSourceStateMachine::PerChannel;
+}
+
+void sACNSource::recycle()
+{
+    int keepSlot = slot;
+    *this = sACNSource();
+    slot = keepSlot;
+}
+
+void sACNSource::updateArrival(qint64 timestamp, qint64 now)
+{
+    if(last_arrival)
+    {
+        qint64 interval = timestamp - last_arrival;
+        if(last_interval)
+        {
+            jitter += (qAbs(interval - last_interval) - jitter) / 16;
+            stats.countJitter(interval - last_interval);
+        }
+        last_interval = interval;
+    }
+    last_arrival = timestamp;
+    processing_delay += ((now - timestamp) - processing_delay) / 16;
+}
+
+bool sACNSource::setName(const char *source_name)
+{
+    if(strncmp(raw_name, source_name, SOURCE_NAME_SIZE) == 0)
+        return false;
+
+    strncpy(raw_name, source_name, SOURCE_NAME_SIZE);
+    raw_name[SOURCE_NAME_SIZE - 1] = '\0';
+    name = QString::fromUtf8(raw_name);
+    return true;
 }
 
 QString sACNSource::cid_string()
@@ -80,15 +164,55 @@ sACNManager *sACNManager::getInstance()
     return m_instance;
 }
 
-sACNManager::sACNManager() : QObject()
+sACNManager::sACNManager() : QObject(),
+    m_receiveWorkerCount(0),
+    m_pinReceiveWorkers(false),
+    m_routeReaderThreads(0)
+{
+    for(int i=0; i<65536; i++)
+        m_routes[i].store(nullptr, std::memory_order_relaxed);
+    for(int i=0; i<SACN_ROUTE_READER_SLOTS; i++)
+        m_routeReaders[i].count.store(0, std::memory_order_relaxed);
+
+    // Stop the receive threads before the application goes away
+    if(QCoreApplication::instance())
+        connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(shutdown()));
+}
+
+sACNManager::~sACNManager()
+{
+    shutdown();
+}
+
+void sACNManager::shutdown()
 {
+    QList<sACNUnicastReceiver *> receivers;
+    QList<QThread *> threads;
+    {
+        QMutexLocker locker(&sACNManager_mutex);
+        receivers.swap(m_unicastReceivers);
+        threads.swap(m_receiveThreads);
+    }
 
+    // The receivers route packets to the listeners of every thread, so they go first.
+    // Objects deleted later are deleted when their thread finishes, before wait() returns.
+    for(sACNUnicastReceiver *receiver : receivers)
+        receiver->deleteLater();
+
+    for(QThread *thread : threads)
+        thread->quit();
+    for(QThread *thread : threads)
+    {
+        thread->wait();
+        delete thread;
+    }
 }
 
 static void strongPointerDelete(sACNListener *obj)
 {
-    obj->deleteLater();
+    // Unpublish first, so that no other thread can route packets to it any more
     sACNManager::getInstance()->listenerDelete(obj);
+    obj->deleteLater();
 }
 
 QSharedPointer<sACNListener> sACNManager::getListener(int universe)
@@ -105,23 +229,18 @@ QSharedPointer<sACNListener> sACNManager::getListener(int universe)
     {
         qDebug() << "Creating Listener for universe " << universe;
 
-        // Create thread and move listener to thread
-        QThread *thread = new QThread;
-        thread->setObjectName(QString("Universe %1 RX").arg(universe));
+        startUnicastReception();
 
+        // Move listener to one of the shared receive threads
         sACNListener *listener = new sACNListener(universe);
-        listener->moveToThread(thread);
-        connect(thread, SIGNAL(started()), listener, SLOT(startReception()));
-        connect(thread, SIGNAL(finished()), listener, SLOT(deleteLater()));
-        connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
-        thread->start(QThread::HighPriority);
-
-        m_listenerThreads[universe] = thread;
+        listener->moveToThread(receiveThread(universe));
+        QMetaObject::invokeMethod(listener, "startReception", Qt::QueuedConnection);
 
         // Create strong pointer to return
         strongPointer = QSharedPointer<sACNListener>(listener, strongPointerDelete);
         m_listenerHash[universe] = strongPointer.toWeakRef();
         m_objToUniverse[listener] = universe;
+        m_routes[quint16(universe)].store(listener);
     }
     else
     {
@@ -138,17 +257,112 @@ QSharedPointer<sACNListener> sACNManager::getListener(int universe)
 }
 
 void sACNManager::listenerDelete(QObject *obj)
+{
+    {
+        QMutexLocker locker(&sACNManager_mutex);
+        int universe = m_objToUniverse[obj];
+
+        qDebug() << "Destroying Listener for universe " << universe;
+
+        m_listenerHash.remove(universe);
+
+        m_objToUniverse.remove(obj);
+
+        m_routes[quint16(universe)].store(nullptr);
+    }
+
+    // Wait for a grace period, after which routePacket() can no longer be using the listener.
+    // Readers only queue a packet, so this is short, and the calling thread is never one of them.
+    for(int i=0; i<SACN_ROUTE_READER_SLOTS; i++)
+        while(m_routeReaders[i].count.load() != 0)
+            QThread::yieldCurrentThread();
+}
+
+sACNManager::RouteReaders &sACNManager::routeReaders()
+{
+    static thread_local int slot = -1;
+    if(slot < 0)
+        slot = m_routeReaderThreads.fetch_add(1) % SACN_ROUTE_READER_SLOTS;
+    return m_routeReaders[slot];
+}
+
+bool sACNManager::routePacket(const sACNPacket &packet, quint16 universe, sACNListener **processedBy)
+{
+    bool accepted = false;
+
+    RouteReaders &readers = routeReaders();
+    readers.count.fetch_add(1);
+    sACNListener *listener = m_routes[universe].load();
+    if(listener && listener->thread() == QThread::currentThread())
+    {
+        // The listener is deleted later on this thread, so it stays valid during this call
+        // without holding up listenerDelete(), whatever the slots connected to it do
+        readers.count.fetch_sub(1, std::memory_order_release);
+        listener->processPacket(packet);
+        if(processedBy)
+            *processedBy = listener;
+        else
+            listener->flushMerge();
+        return true;
+    }
+    if(listener)
+        accepted = listener->queuePacket(packet);
+    readers.count.fetch_sub(1, std::memory_order_release);
+
+    return accepted;
+}
+
+void sACNManager::setReceiveWorkers(int count, bool pinToCores)
 {
     QMutexLocker locker(&sACNManager_mutex);
-    int universe = m_objToUniverse[obj];
+    if(!m_receiveThreads.isEmpty())
+    {
+        qDebug() << "sACNManager: Receive workers already running, configuration ignored";
+        return;
+    }
+    m_receiveWorkerCount = count;
+    m_pinReceiveWorkers = pinToCores;
+}
 
-    qDebug() << "Destroying Listener for universe " << universe;
+QThread *sACNManager::receiveThread(int universe)
+{
+    // The receive threads are created on first use and live as long as the manager.
+    // Each thread's event loop multiplexes the sockets and timers of all the listeners
+    // assigned to it, so the thread count follows the cores and not the universes.
+    if(m_receiveThreads.isEmpty())
+    {
+        int count = m_receiveWorkerCount > 0 ? m_receiveWorkerCount : qMax(1, QThread::idealThreadCount());
+        for(int i=0; i<count; i++)
+        {
+            QThread *thread = new sACNReceiveThread(m_pinReceiveWorkers ? i : -1);
+            thread->setObjectName(QString("sACN RX %1").arg(i));
+            thread->start(QThread::HighPriority);
+            m_receiveThreads << thread;
+        }
+    }
 
-    m_listenerHash.remove(universe);
+    return m_receiveThreads[universe % m_receiveThreads.count()];
+}
 
-    m_objToUniverse.remove(obj);
+void sACNManager::startUnicastReception()
+{
+    if(!m_unicastReceivers.isEmpty())
+        return;
 
-    m_listenerThreads[universe]->exit();
-    m_listenerThreads[universe]->wait();
-    m_listenerThreads.remove(universe);
+    // By default one unicast socket serves all universes. Only if more than one worker was
+    // asked for with setReceiveWorkers(), every worker gets a shard of a SO_REUSEPORT group
+    // and routes what it receives
+    receiveThread(0);
+    int shards = m_receiveWorkerCount > 1 ? m_receiveThreads.count() : 1;
+    for(int i=0; i<shards; i++)
+    {
+        sACNUnicastReceiver *receiver;
+        if(shards == 1)
+            receiver = new sACNUnicastReceiver;
+        else
+            receiver = new sACNUnicastReceiver(i, m_pinReceiveWorkers ? i : -1);
+        receiver->moveToThread(m_receiveThreads[i]);
+        QMetaObject::invokeMethod(receiver, "startReception", Qt::QueuedConnection);
+        m_unicastReceivers << receiver;
+    }
 }
@@ -29,14 +29,28 @@
 #include <QHostAddress>
 #include <QElapsedTimer>
 #include <QMutex>
+#include <QMetaType>
+#include <atomic>
 
 #include "ACNShare/deftypes.h"
 #include "ACNShare/CID.h"
 #include "ACNShare/tock.h"
+#include "streamcommon.h"
+#include "sacnaddressmask.h"
+#include "sacnsourcestate.h"
+#include "sacnsourcestats.h"
 
 // Forward Declarations
 class sACNListener;
 class sACNSentUniverse;
+class sACNUnicastReceiver;
+struct sACNPacket;
+
+// The number of sources a listener keeps track of for one universe
+#define SACN_MAX_SOURCES 64
+
+// The number of reader counters of sACNManager::routePacket(), threads beyond it share them
+#define SACN_ROUTE_READER_SLOTS 64
 
 enum StreamingACNProtocolVersion
 {
@@ -51,6 +65,24 @@ class sACNSource
 public:
     explicit sACNSource();
     CID src_cid;
+    // Dense index of this source in its listener, usable as a bit position
+    int slot;
+    // Lifecycle of the slot in the source arena of the listener
+    enum SlotState
+    {
+        SlotInUse,  // Online or offline, but known by its CID
+        SlotRetired, // Forgotten and out of the arena, deleted once sACNListener::releaseSource() was called for it
+        SlotFree    // Ready to be reused for a new source
+    };
+    SlotState slot_state;
+    // Offline sources are retired when this expires
+    ttimer reclaim_wait;
+    // Resets everything but the slot, for reuse of the object by a new source
+    void recycle();
+    // The sACNSourceStateMachine::StateFlag bits, src_valid, waited_for_dd, doing_dmx and
+    // doing_per_channel are copies of them for reading
+    quint8 state;
+    void setState(quint8 newState);
     bool src_valid;
     uint1 lastseq;
     ttimer active;  //If this expires, we haven't received any data in over a second
@@ -66,14 +98,15 @@ public:
     quint16 universe;
     uint1 level_array[512];
     uint1 priority_array[512];
-    uint1 last_level_array[512];
-    uint1 last_priority_array[512];
-    bool dirty_array[512]; // Set if an individual level or priority has changed
+    sACNAddressMask dirty_mask; // Set if an individual level or priority has changed
     bool source_params_change; // Set if any parameter of the source changes between packets
     bool source_levels_change;
 
     uint1 priority;
     QString name;
+    // The name as received, so that name only needs to be decoded when it changes
+    char raw_name[SOURCE_NAME_SIZE];
+    bool setName(const char *source_name);
     QString cid_string();
     QHostAddress ip;
     // Used for the calculation of the frames per second
@@ -84,9 +117,22 @@ public:
     int seqErr;
     // The number of jumps (increments by anything other than 1) of this source
     int jumps;
+    // Loss, reordering and jitter, published by the listener with every packet
+    sACNSourceStats stats;
+    // Receive time of the last packet, in ns since the epoch, taken by the kernel where supported
+    qint64 last_arrival;
+    // Time between the last two packets, in ns
+    qint64 last_interval;
+    // Variation of the time between packets, in ns, smoothed as the RFC 3550 interarrival jitter
+    qint64 jitter;
+    // Time from receiving a packet to processing it, in ns, smoothed the same way
+    qint64 processing_delay;
+    void updateArrival(qint64 timestamp, qint64 now);
     // Protocol Version
     StreamingACNProtocolVersion protocol_version;
 };
+Q_DECLARE_METATYPE(sACNSource *)
+Q_DECLARE_METATYPE(CID)
 
 
 // The sACNManager class is a singleton that manages the lifespan of sACNTransmitters and sACNListeners.
@@ -99,14 +145,68 @@ public:
     QSharedPointer<sACNListener> getListener(int universe);
 
     const QHash<int, QWeakPointer<sACNListener> > getListenerList() { return m_listenerHash; }
+
+    /**
+     * @brief routePacket hands a packet to the listener for a universe, if there is one.
+     * The packet is processed right away if the listener lives on the calling thread, otherwise
+     * it is queued for the thread of the listener. Lock-free and safe to call from any thread.
+     * @param processedBy if given, receives the listener which processed the packet right away,
+     * the caller must then call its sACNListener::flushMerge() at the end of the batch.
+     * Otherwise the listener merges after this packet.
+     * @return true if a listener accepted the packet
+     */
+    bool routePacket(const sACNPacket &packet, quint16 universe, sACNListener **processedBy = nullptr);
+
+    /**
+     * @brief setReceiveWorkers configures the receive threads shared by all listeners.
+     * Must be called before the first listener is created to take effect!
+     * Universes are assigned to the workers by their number. With a count above one, each worker
+     * also gets its own unicast socket, the sockets share the port with SO_REUSEPORT on Linux.
+     * Otherwise a single unicast socket serves all workers.
+     * @param count the number of worker threads, 0 for one per core
+     * @param pinToCores if true, worker n is pinned to core n and its unicast socket asks the kernel
+     * for the packets handled by that core (Linux only)
+     */
+    void setReceiveWorkers(int count, bool pinToCores = false);
+
+    /**
+     * @brief receiveThreadCount
+     * @return the number of threads shared by all listeners
+     */
+    int receiveThreadCount() { return m_receiveThreads.count(); }
 public slots:
     void listenerDelete(QObject *obj = Q_NULLPTR);
+    /**
+     * @brief shutdown deletes the unicast receivers, then stops and deletes the receive threads.
+     * Listeners released before are deleted as their thread finishes, listeners still held
+     * afterwards no longer receive. Called when the application quits, must not be called
+     * from a receive thread.
+     */
+    void shutdown();
 private:
     sACNManager();
+    ~sACNManager();
+    QThread *receiveThread(int universe);
+    void startUnicastReception();
     QMutex sACNManager_mutex;
     QHash<int, QWeakPointer<sACNListener> > m_listenerHash;
-    QHash<int, QThread *> m_listenerThreads;
+    int m_receiveWorkerCount;
+    bool m_pinReceiveWorkers;
+    QList<QThread *> m_receiveThreads;
+    QList<sACNUnicastReceiver *> m_unicastReceivers;
     QHash<QObject*, int> m_objToUniverse;
+    // Listeners by universe number, read without locks by routePacket()
+    std::atomic<sACNListener *> m_routes[65536];
+    // The number of routePacket() calls handing a packet to another thread, counted per
+    // thread on separate cache lines. A listener is only destroyed once no reader can still hold it.
+    struct RouteReaders
+    {
+        std::atomic<int> count;
+        char padding[64 - sizeof(std::atomic<int>)];
+    };
+    RouteReaders m_routeReaders[SACN_ROUTE_READER_SLOTS];
+    std::atomic<int> m_routeReaderThreads;
+    RouteReaders &routeReaders();
     static sACNManager *m_instance;
 };
 
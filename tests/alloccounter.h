@@ -0,0 +1,29 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <cstdint>
+
+/*
+ * Linking alloccounter.cpp replaces the global operator new, which then counts
+ * the allocations of all threads.
+ */
+
+/**
+ * @brief allocationCount
+ * @return the number of calls of operator new so far
+ */
+uint64_t allocationCount();
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,120 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Times a full 512 address HTP merge with 1, 4, 16 and 64 sources, the source-major multimap
+// merge sACNListener::performMerge() used to do against sACNMerge(), and counts the heap
+// allocations of each. Fails if sACNMerge() allocates.
+
+#include <QtTest>
+#include "sacnkernels.h"
+#include "alloccounter.h"
+#include "reference.h"
+#include "testutil.h"
+
+// The merges the allocations are counted over
+#define BENCH_COUNTED_MERGES 100
+
+class BenchMerge : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void multimap_data();
+    void multimap();
+    void kernel_data();
+    void kernel();
+
+private:
+    void addSourceCounts();
+};
+
+static uint1 s_levels[SACN_MERGE_MAX_ROWS][512];
+static uint1 s_priorities[SACN_MERGE_MAX_ROWS][512];
+static sACNMergeInput s_input;
+
+void BenchMerge::initTestCase()
+{
+    TestRandom random(7);
+    s_input.lastChanged = nullptr;
+    for(int r = 0; r < SACN_MERGE_MAX_ROWS; r++)
+    {
+        s_input.levels[r] = s_levels[r];
+        s_input.priorities[r] = s_priorities[r];
+        s_input.perChannel[r] = r % 2;
+        s_input.ids[r] = uint1(r);
+        for(int a = 0; a < 512; a++)
+        {
+            s_levels[r][a] = uint1(random.next());
+            s_priorities[r][a] = uint1(random.bounded(2) * 100);
+        }
+    }
+}
+
+void BenchMerge::addSourceCounts()
+{
+    QTest::addColumn<int>("sources");
+    QTest::newRow("1 source") << 1;
+    QTest::newRow("4 sources") << 4;
+    QTest::newRow("16 sources") << 16;
+    QTest::newRow("64 sources") << 64;
+}
+
+void BenchMerge::multimap_data()
+{
+    addSourceCounts();
+}
+
+void BenchMerge::multimap()
+{
+    QFETCH(int, sources);
+    s_input.rows = sources;
+    int mergedLevels[512], mergedPriorities[512];
+    int i = 0;
+    QBENCHMARK {
+        referenceMergeHTP(s_input, mergedLevels, mergedPriorities);
+        // One address changes between merges, as with a fader being moved
+        s_levels[0][i++ & 511]++;
+    }
+
+    quint64 before = allocationCount();
+    for(int merge = 0; merge < BENCH_COUNTED_MERGES; merge++)
+        referenceMergeHTP(s_input, mergedLevels, mergedPriorities);
+    qInfo("%.1f allocations per merge", double(allocationCount() - before) / BENCH_COUNTED_MERGES);
+}
+
+void BenchMerge::kernel_data()
+{
+    addSourceCounts();
+}
+
+void BenchMerge::kernel()
+{
+    QFETCH(int, sources);
+    s_input.rows = sources;
+    sACNAddressMask all;
+    all.setAll();
+    sACNMergeOutput output;
+    int i = 0;
+    QBENCHMARK {
+        sACNMerge(sACNMergeHTP, s_input, all, output);
+        s_levels[0][i++ & 511]++;
+    }
+
+    quint64 before = allocationCount();
+    for(int merge = 0; merge < BENCH_COUNTED_MERGES; merge++)
+        sACNMerge(sACNMergeHTP, s_input, all, output);
+    QCOMPARE(allocationCount() - before, quint64(0));
+}
+
+QTEST_APPLESS_MAIN(BenchMerge)
+
+#include "bench_merge.moc"
@@ -0,0 +1,14 @@
+include(../tests.pri)
+
+TARGET = bench_merge
+CONFIG += release
+
+SOURCES += \
+    bench_merge.cpp \
+    ../alloccounter.cpp \
+    $$SACN_DIR/sacnkernels.cpp
+
+HEADERS += \
+    ../alloccounter.h \
+    $$SACN_DIR/sacnkernels.h \
+    $$SACN_DIR/sacnaddressmask.h
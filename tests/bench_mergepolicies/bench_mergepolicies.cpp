@@ -0,0 +1,85 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Times a full 512 address merge of each policy of sACNMerge() with 1, 4, 16 and 64 sources.
+
+#include <QtTest>
+#include "sacnkernels.h"
+#include "testutil.h"
+
+class BenchMergePolicies : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void merge_data();
+    void merge();
+};
+
+static uint1 s_levels[SACN_MERGE_MAX_ROWS][512];
+static uint1 s_priorities[SACN_MERGE_MAX_ROWS][512];
+static uint1 s_lastChanged[512];
+static sACNMergeInput s_input;
+
+void BenchMergePolicies::initTestCase()
+{
+    TestRandom random(9);
+    s_input.lastChanged = s_lastChanged;
+    for(int r = 0; r < SACN_MERGE_MAX_ROWS; r++)
+    {
+        s_input.levels[r] = s_levels[r];
+        s_input.priorities[r] = s_priorities[r];
+        s_input.perChannel[r] = r % 2;
+        s_input.ids[r] = uint1(r);
+        for(int a = 0; a < 512; a++)
+        {
+            s_levels[r][a] = uint1(random.next());
+            s_priorities[r][a] = uint1(random.bounded(2) * 100);
+        }
+    }
+    for(int a = 0; a < 512; a++)
+        s_lastChanged[a] = uint1(random.bounded(SACN_MERGE_MAX_ROWS));
+}
+
+void BenchMergePolicies::merge_data()
+{
+    QTest::addColumn<int>("policy");
+    QTest::addColumn<int>("sources");
+
+    const char *names[] = {"HTP", "LTP", "MostRecent", "ForcedSource"};
+    const int sourceCounts[] = {1, 4, 16, 64};
+    for(int policy = sACNMergeHTP; policy <= sACNMergeForcedSource; policy++)
+    {
+        for(int sources : sourceCounts)
+            QTest::newRow(qPrintable(QString("%1, %2 sources").arg(names[policy]).arg(sources))) << policy << sources;
+    }
+}
+
+void BenchMergePolicies::merge()
+{
+    QFETCH(int, policy);
+    QFETCH(int, sources);
+    s_input.rows = sources;
+    sACNAddressMask all;
+    all.setAll();
+    sACNMergeOutput output;
+    int i = 0;
+    QBENCHMARK {
+        sACNMerge(sACNMergePolicy(policy), s_input, all, output);
+        // One address changes between merges, as with a fader being moved
+        s_levels[0][i++ & 511]++;
+    }
+}
+
+QTEST_APPLESS_MAIN(BenchMergePolicies)
+
+#include "bench_mergepolicies.moc"
@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+TARGET = bench_mergepolicies
+CONFIG += release
+
+SOURCES += \
+    bench_mergepolicies.cpp \
+    $$SACN_DIR/sacnkernels.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacnkernels.h \
+    $$SACN_DIR/sacnaddressmask.h
@@ -0,0 +1,107 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs packets and merges of one listener back to back on this thread, first alone and then while
+// another thread keeps monitoring, reading and unmonitoring addresses as a busy UI would.
+// Reports the median merge time and prints the merges per second and the merge time percentiles.
+
+#include <QtTest>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "sacnlistener.h"
+#include "testpacket.h"
+#include "testutil.h"
+
+#define BENCH_UNIVERSE 1
+#define BENCH_MERGES 200000
+
+class BenchMonitor : public QObject
+{
+    Q_OBJECT
+private slots:
+    void merge_data();
+    void merge();
+};
+
+static void toggleMonitors(sACNListener *listener, std::atomic<bool> *running, quint64 *toggles)
+{
+    TestRandom random(11);
+    sACNSample samples[64];
+    while(running->load(std::memory_order_relaxed))
+    {
+        int address = random.bounded(512);
+        listener->monitorAddress(address);
+        listener->readSamples(address, samples, 64);
+        listener->unMonitorAddress(random.bounded(512));
+        ++*toggles;
+    }
+}
+
+void BenchMonitor::merge_data()
+{
+    QTest::addColumn<bool>("contended");
+    QTest::newRow("alone") << false;
+    QTest::newRow("contended") << true;
+}
+
+void BenchMonitor::merge()
+{
+    QFETCH(bool, contended);
+
+    sACNListener listener(BENCH_UNIVERSE);
+    static sACNPacket packet;
+    initTestPacket(packet, CID::CreateCid(), "Bench source", 100, STARTCODE_DMX, BENCH_UNIVERSE);
+    // Some addresses stay monitored throughout, as a UI showing a few graphs would
+    for(int address = 0; address < 512; address += 64)
+        listener.monitorAddress(address);
+
+    std::atomic<bool> running(true);
+    quint64 toggles = 0;
+    std::thread ui;
+    if(contended)
+        ui = std::thread(toggleMonitors, &listener, &running, &toggles);
+
+    std::vector<qint64> mergeNs(BENCH_MERGES);
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+    for(int i = 0; i < BENCH_MERGES; i++)
+    {
+        SetStreamHeaderSequence(packet.data, uint1(i), false);
+        packet.data[STREAM_HEADER_SIZE + (i & 511)] = uint1(i);
+        packet.timestamp = sACNPacket::currentTime();
+        listener.processPacket(packet);
+
+        timer.start();
+        QMetaObject::invokeMethod(&listener, "performMerge", Qt::DirectConnection);
+        mergeNs[i] = timer.nsecsElapsed();
+    }
+    double seconds = total.nsecsElapsed() / 1e9;
+
+    running.store(false);
+    if(ui.joinable())
+        ui.join();
+    // Drop the merges the packets posted
+    QCoreApplication::sendPostedEvents();
+
+    std::sort(mergeNs.begin(), mergeNs.end());
+    qInfo("%.0f merges/s, p50 %.2f us, p99 %.2f us, max %.2f us, %.0f UI calls/s", BENCH_MERGES / seconds,
+          mergeNs[BENCH_MERGES / 2] / 1e3, mergeNs[BENCH_MERGES * 99 / 100] / 1e3, mergeNs.back() / 1e3,
+          toggles / seconds);
+    QTest::setBenchmarkResult(mergeNs[BENCH_MERGES / 2], QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(BenchMonitor)
+
+#include "bench_monitor.moc"
@@ -0,0 +1,11 @@
+include(../tests.pri)
+include(../sacn.pri)
+
+TARGET = bench_monitor
+CONFIG += release
+
+SOURCES += \
+    bench_monitor.cpp
+
+HEADERS += \
+    ../testpacket.h
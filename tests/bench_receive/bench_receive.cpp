@@ -0,0 +1,138 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Floods the unicast sACN port on loopback and counts the datagrams one thread reads, reading
+// them one by one into a QByteArray as the listener used to, and in batches with
+// sACNRxSocket::readDatagramBatch(). Reports the wall time per datagram and prints the
+// datagrams per second of wall and of CPU time.
+
+#include <QtTest>
+#include <QNetworkInterface>
+#include <QUdpSocket>
+#include <atomic>
+#include <thread>
+#include "sacnsocket.h"
+#include "streamcommon.h"
+
+#ifdef Q_OS_LINUX
+#include <time.h>
+#endif
+
+// The length of a data packet with all 512 addresses
+#define BENCH_PACKET_SIZE 638
+
+#define BENCH_SECONDS 3
+
+class BenchReceive : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void readDatagram();
+    void readDatagramBatch();
+};
+
+// The CPU time of the calling thread in ns, -1 where it is not available
+static qint64 threadCpuNs()
+{
+#ifdef Q_OS_LINUX
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+    return -1;
+#endif
+}
+
+static void flood(std::atomic<bool> *running)
+{
+    QUdpSocket socket;
+    char packet[BENCH_PACKET_SIZE] = {};
+    QHostAddress loopback(QHostAddress::LocalHost);
+    while(running->load(std::memory_order_relaxed))
+        socket.writeDatagram(packet, sizeof(packet), loopback, STREAM_IP_PORT);
+}
+
+// Reads with read() for BENCH_SECONDS while another thread floods the port
+template<typename Read>
+static void measure(QUdpSocket &socket, Read read)
+{
+    std::atomic<bool> running(true);
+    std::thread sender(flood, &running);
+
+    quint64 packets = 0;
+    qint64 cpuStart = threadCpuNs();
+    QElapsedTimer timer;
+    timer.start();
+    while(timer.elapsed() < BENCH_SECONDS * 1000)
+    {
+        if(socket.waitForReadyRead(100))
+            packets += read();
+    }
+    qint64 wallNs = timer.nsecsElapsed();
+    qint64 cpuNs = threadCpuNs() - cpuStart;
+
+    running.store(false);
+    sender.join();
+
+    QVERIFY(packets > 0);
+    if(cpuStart < 0)
+        qInfo("%.0f datagrams/s", packets * 1e9 / wallNs);
+    else
+        qInfo("%.0f datagrams/s, %.0f datagrams/s of CPU", packets * 1e9 / wallNs, packets * 1e9 / cpuNs);
+    QTest::setBenchmarkResult(qreal(wallNs) / packets, QTest::WalltimeNanoseconds);
+}
+
+void BenchReceive::initTestCase()
+{
+    foreach(QNetworkInterface iface, QNetworkInterface::allInterfaces())
+    {
+        if(iface.flags() & QNetworkInterface::IsLoopBack)
+            sACNRxSocket::setNetworkInterface(iface);
+    }
+}
+
+void BenchReceive::readDatagram()
+{
+    QUdpSocket socket;
+    QVERIFY2(socket.bind(QHostAddress(QHostAddress::LocalHost), STREAM_IP_PORT), "Could not bind the sACN port on loopback");
+    measure(socket, [&socket]() {
+        quint64 count = 0;
+        while(socket.hasPendingDatagrams())
+        {
+            QByteArray data;
+            data.resize(int(socket.pendingDatagramSize()));
+            QHostAddress sender;
+            quint16 senderPort;
+            socket.readDatagram(data.data(), data.size(), &sender, &senderPort);
+            count++;
+        }
+        return count;
+    });
+}
+
+void BenchReceive::readDatagramBatch()
+{
+    sACNRxSocket socket;
+    QVERIFY2(socket.bindUnicast(), "Could not bind the sACN port on loopback");
+    measure(socket, [&socket]() {
+        quint64 count = 0;
+        int batch;
+        while((batch = socket.readDatagramBatch()) > 0)
+            count += batch;
+        return count;
+    });
+}
+
+QTEST_GUILESS_MAIN(BenchReceive)
+
+#include "bench_receive.moc"
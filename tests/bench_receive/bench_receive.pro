@@ -0,0 +1,8 @@
+include(../tests.pri)
+include(../sacn.pri)
+
+TARGET = bench_receive
+CONFIG += release
+
+SOURCES += \
+    bench_receive.cpp
@@ -0,0 +1,116 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Times the per-packet source logic, the branches of sACNSourceStateMachine::receive() that
+// the listener runs against the table of receiveTable(), on a stream from 64 sources sending
+// DMX and per-channel priority, with the occasional late packet and a few sources terminating
+// and coming back. Reports the time per packet.
+
+#include <QtTest>
+#include <vector>
+#include "sourcestatemodel.h"
+#include "testutil.h"
+
+#define BENCH_SOURCES 64
+#define BENCH_PACKETS (1 << 20)
+#define BENCH_ROUNDS 20
+
+struct BenchPacket
+{
+    int source;
+    ModelPacket packet;
+};
+
+typedef void (*BenchStep)(ModelSource &, bool, const ModelPacket &, bool, bool &, bool &);
+
+class BenchSourceState : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void step_data();
+    void step();
+    void sameResult();
+
+private:
+    std::vector<BenchPacket> m_stream;
+};
+
+// Runs the stream through step, returns the number of packets it took
+static int run(const std::vector<BenchPacket> &stream, BenchStep step)
+{
+    ModelSource sources[BENCH_SOURCES];
+    bool found[BENCH_SOURCES];
+    for(int s = 0; s < BENCH_SOURCES; s++)
+    {
+        sources[s].init(0);
+        found[s] = false;
+    }
+    int processed = 0;
+    for(const BenchPacket &packet : stream)
+    {
+        ModelSource &source = sources[packet.source];
+        // The priority wait of a source runs out after a few packets
+        source.priority_wait.expired = (packet.packet.sequence & 7) == 7;
+        bool valid, notify;
+        step(source, found[packet.source], packet.packet, false, valid, notify);
+        found[packet.source] = true;
+        processed += valid;
+    }
+    return processed;
+}
+
+void BenchSourceState::initTestCase()
+{
+    TestRandom random(13);
+    quint8 sequences[BENCH_SOURCES] = {};
+    m_stream.resize(BENCH_PACKETS);
+    for(BenchPacket &packet : m_stream)
+    {
+        packet.source = random.bounded(BENCH_SOURCES);
+        int kind = random.bounded(1000);
+        // Mostly DMX, every fourth packet priority, some late ones and a few terminations
+        packet.packet.startCode = kind % 4 == 3 ? STARTCODE_PRIORITY : STARTCODE_DMX;
+        packet.packet.terminated = kind == 0;
+        quint8 &sequence = sequences[packet.source];
+        packet.packet.sequence = kind < 10 ? quint8(sequence - 2) : ++sequence;
+    }
+}
+
+void BenchSourceState::step_data()
+{
+    QTest::addColumn<bool>("table");
+    QTest::newRow("branches") << false;
+    QTest::newRow("table") << true;
+}
+
+void BenchSourceState::step()
+{
+    QFETCH(bool, table);
+    BenchStep step = table ? modelSourceStep<true> : modelSourceStep<false>;
+    QElapsedTimer timer;
+    timer.start();
+    for(int round = 0; round < BENCH_ROUNDS; round++)
+        run(m_stream, step);
+    double ns = double(timer.nsecsElapsed()) / (double(BENCH_ROUNDS) * m_stream.size());
+    qInfo("%.2f ns/packet", ns);
+    QTest::setBenchmarkResult(ns, QTest::WalltimeNanoseconds);
+}
+
+void BenchSourceState::sameResult()
+{
+    QCOMPARE(run(m_stream, modelSourceStep<true>), run(m_stream, modelSourceStep<false>));
+}
+
+QTEST_APPLESS_MAIN(BenchSourceState)
+
+#include "bench_sourcestate.moc"
@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+TARGET = bench_sourcestate
+CONFIG += release
+
+SOURCES += \
+    bench_sourcestate.cpp \
+    $$SACN_DIR/sacnsourcestate.cpp
+
+HEADERS += \
+    ../sourcestatemodel.h \
+    $$SACN_DIR/sacnsourcestate.h
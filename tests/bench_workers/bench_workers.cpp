@@ -0,0 +1,188 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Floods 64 universes over unicast on loopback from several sending threads and counts the
+// packets the listeners process per second, with 1, 2, 4 ... receive workers up to one per
+// core. The workers are configured once per process, so scaling() runs measure() in a child
+// process for each count. Set BENCH_PIN=1 in the environment to pin the workers to cores.
+// Loopback senders share the cores with the workers, so the numbers flatten out early.
+
+#include <QtTest>
+#include <QNetworkInterface>
+#include <QProcess>
+#include <QUdpSocket>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "sacnlistener.h"
+#include "testpacket.h"
+
+#define BENCH_UNIVERSES 64
+#define BENCH_SENDERS 4
+#define BENCH_WARMUP_SECONDS 1
+#define BENCH_SECONDS 3
+
+// Set in the environment of the child processes to the number of workers
+#define BENCH_WORKERS_VARIABLE "BENCH_WORKERS"
+// The line a child process prints its result on
+#define BENCH_RESULT_PREFIX "BENCH_RESULT"
+
+class BenchWorkers : public QObject
+{
+    Q_OBJECT
+private slots:
+    void scaling_data();
+    void scaling();
+    void measure();
+};
+
+static sACNPacket s_packets[BENCH_SENDERS][BENCH_UNIVERSES];
+
+static void flood(int sender, std::atomic<bool> *running)
+{
+    QUdpSocket socket;
+    QHostAddress loopback(QHostAddress::LocalHost);
+    for(uint1 sequence = 0; running->load(std::memory_order_relaxed); sequence++)
+    {
+        for(int u = 0; u < BENCH_UNIVERSES; u++)
+        {
+            sACNPacket &packet = s_packets[sender][u];
+            SetStreamHeaderSequence(packet.data, sequence, false);
+            packet.data[STREAM_HEADER_SIZE] = sequence;
+            socket.writeDatagram(reinterpret_cast<const char *>(packet.data), packet.length, loopback, STREAM_IP_PORT);
+        }
+    }
+}
+
+typedef std::vector<std::pair<sACNListener *, sACNSource *> > BenchSources;
+
+static quint64 processedPackets(const BenchSources &sources)
+{
+    quint64 packets = 0;
+    for(const auto &source : sources)
+    {
+        sACNSourceStats stats;
+        source.first->sourceStats(source.second, stats);
+        packets += stats.packets;
+    }
+    return packets;
+}
+
+static void runEventsFor(int seconds)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while(timer.elapsed() < seconds * 1000)
+        QCoreApplication::processEvents();
+}
+
+void BenchWorkers::scaling_data()
+{
+    QTest::addColumn<int>("workers");
+
+    // Powers of two, then one worker per core
+    int cores = QThread::idealThreadCount();
+    for(int workers = 1; workers < cores; workers *= 2)
+        QTest::newRow(qPrintable(QString("%1 workers").arg(workers))) << workers;
+    QTest::newRow(qPrintable(QString("%1 workers").arg(cores))) << cores;
+}
+
+void BenchWorkers::scaling()
+{
+    QFETCH(int, workers);
+
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(BENCH_WORKERS_VARIABLE, QString::number(workers));
+    QProcess child;
+    child.setProcessEnvironment(environment);
+    child.start(QCoreApplication::applicationFilePath(), QStringList() << "measure");
+    QVERIFY(child.waitForFinished((BENCH_WARMUP_SECONDS + BENCH_SECONDS + 30) * 1000));
+    QCOMPARE(child.exitCode(), 0);
+
+    QStringList result;
+    foreach(QString line, QString::fromLatin1(child.readAllStandardOutput()).split('\n'))
+    {
+        if(line.startsWith(BENCH_RESULT_PREFIX))
+            result = line.split(' ');
+    }
+    QVERIFY2(result.size() == 3, "The child process printed no result");
+    int sources = result[1].toInt();
+    double packetsPerSecond = result[2].toDouble();
+    QVERIFY(packetsPerSecond > 0);
+
+    qInfo("%d workers, %d sources: %.0f packets/s", workers, sources, packetsPerSecond);
+    QTest::setBenchmarkResult(1e9 / packetsPerSecond, QTest::WalltimeNanoseconds);
+}
+
+void BenchWorkers::measure()
+{
+    QByteArray workers = qgetenv(BENCH_WORKERS_VARIABLE);
+    if(workers.isEmpty())
+        QSKIP("Runs in the child processes started by scaling()");
+
+    foreach(QNetworkInterface iface, QNetworkInterface::allInterfaces())
+    {
+        if(iface.flags() & QNetworkInterface::IsLoopBack)
+            sACNRxSocket::setNetworkInterface(iface);
+    }
+    sACNManager::getInstance()->setReceiveWorkers(workers.toInt(), qgetenv("BENCH_PIN") == "1");
+
+    // Sources are collected on this thread as the listeners find them
+    BenchSources sources;
+    QList<QSharedPointer<sACNListener> > listeners;
+    for(int u = 1; u <= BENCH_UNIVERSES; u++)
+    {
+        QSharedPointer<sACNListener> listener = sACNManager::getInstance()->getListener(u);
+        sACNListener *receiver = listener.data();
+        QObject::connect(receiver, &sACNListener::sourceFound, QCoreApplication::instance(),
+                         [&sources, receiver](sACNSource *source) { sources.push_back(std::make_pair(receiver, source)); });
+        listeners << listener;
+    }
+
+    for(int s = 0; s < BENCH_SENDERS; s++)
+    {
+        CID cid = CID::CreateCid();
+        for(int u = 0; u < BENCH_UNIVERSES; u++)
+            initTestPacket(s_packets[s][u], cid, "Bench source", 100, STARTCODE_DMX, uint2(u + 1));
+    }
+    std::atomic<bool> running(true);
+    std::vector<std::thread> senders;
+    for(int s = 0; s < BENCH_SENDERS; s++)
+        senders.emplace_back(flood, s, &running);
+
+    runEventsFor(BENCH_WARMUP_SECONDS);
+    quint64 start = processedPackets(sources);
+    QElapsedTimer timer;
+    timer.start();
+    runEventsFor(BENCH_SECONDS);
+    quint64 packets = processedPackets(sources) - start;
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    running.store(false);
+    for(std::thread &sender : senders)
+        sender.join();
+
+    std::printf(BENCH_RESULT_PREFIX " %d %.0f\n", int(sources.size()), packets / seconds);
+    std::fflush(stdout);
+
+    // Release the listeners, then stop the workers, which deletes them
+    listeners.clear();
+    sACNManager::getInstance()->shutdown();
+    QCOMPARE(sACNManager::getInstance()->receiveThreadCount(), 0);
+    // Drop the sourceFound() calls still queued for this thread
+    QCoreApplication::removePostedEvents(QCoreApplication::instance(), QEvent::MetaCall);
+}
+
+QTEST_GUILESS_MAIN(BenchWorkers)
+#include "bench_workers.moc"
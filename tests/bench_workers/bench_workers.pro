@@ -0,0 +1,11 @@
+include(../tests.pri)
+include(../sacn.pri)
+
+TARGET = bench_workers
+CONFIG += release
+
+SOURCES += \
+    bench_workers.cpp
+
+HEADERS += \
+    ../testpacket.h
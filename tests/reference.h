@@ -0,0 +1,141 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include <map>
+#include <string.h>
+#include "sacnkernels.h"
+
+/*
+ * Straightforward versions of the receive path loops, to check the optimized ones against
+ * and to benchmark them with.
+ */
+
+/**
+ * @brief referenceUpdateFrame does what sACNUpdateFrame() does, one address at a time
+ */
+inline bool referenceUpdateFrame(uint1 *frame, const uint1 *data, int count, sACNAddressMask &changed)
+{
+    bool any = false;
+    for(int i = 0; i < 512; i++)
+    {
+        uint1 level = i < count ? data[i] : 0;
+        if(frame[i] != level)
+        {
+            changed.set(i);
+            any = true;
+        }
+        frame[i] = level;
+    }
+    return any;
+}
+
+/**
+ * @brief referenceMergeHTP is the HTP merge sACNListener::performMerge() did before sACNMerge():
+ * source by source, collecting the sources of the highest priority of each address in a multimap.
+ * std::multimap stands in for the QMultiMap it used.
+ * @param levels receives the merged level of each address, -1 if no source sends it
+ * @param priorities receives the winning priority of each address, -1 if no source sends it
+ */
+inline void referenceMergeHTP(const sACNMergeInput &input, int *levels, int *priorities)
+{
+    for(int a = 0; a < 512; a++)
+    {
+        levels[a] = -1;
+        priorities[a] = -1;
+    }
+
+    std::multimap<int, int> addressToSourceMap;
+    for(int r = 0; r < input.rows; r++)
+    {
+        for(int a = 0; a < 512; a++)
+        {
+            int priority = input.priorities[r][a];
+            if(!(priority < priorities[a]) && (priority > 0 || !input.perChannel[r]))
+            {
+                if(priority > priorities[a])
+                {
+                    priorities[a] = priority;
+                    addressToSourceMap.erase(a);
+                }
+                addressToSourceMap.insert(std::make_pair(a, r));
+            }
+        }
+    }
+
+    for(int a = 0; a < 512; a++)
+    {
+        auto range = addressToSourceMap.equal_range(a);
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            if(input.levels[it->second][a] > levels[a])
+                levels[a] = input.levels[it->second][a];
+        }
+    }
+}
+
+/**
+ * @brief referenceMerge merges one address the way sACNMerge() documents it, one row at a time
+ * @param level, priority and winner receive the result, 0, 0 and SACN_NO_WINNER if no row sends it
+ */
+inline void referenceMerge(sACNMergePolicy policy, const sACNMergeInput &input, int address,
+                           int &level, int &priority, int &winner)
+{
+    level = 0;
+    priority = 0;
+    winner = SACN_NO_WINNER;
+
+    // A row with per-channel priority sends an address unless its priority is 0
+    bool sending[SACN_MERGE_MAX_ROWS];
+    int highest = -1;
+    for(int r = 0; r < input.rows; r++)
+    {
+        sending[r] = input.priorities[r][address] > 0 || !input.perChannel[r];
+        if(sending[r] && input.priorities[r][address] > highest)
+            highest = input.priorities[r][address];
+    }
+    if(highest < 0)
+        return;
+
+    if(policy == sACNMergeForcedSource && sending[0])
+    {
+        level = input.levels[0][address];
+        priority = input.priorities[0][address];
+        winner = 0;
+        return;
+    }
+
+    priority = highest;
+    for(int r = 0; r < input.rows; r++)
+    {
+        if(!sending[r] || input.priorities[r][address] != highest)
+            continue;
+        bool wins;
+        if(policy == sACNMergeMostRecent)
+            wins = winner == SACN_NO_WINNER;
+        else if(policy == sACNMergeLTP && input.ids[r] == input.lastChanged[address])
+            wins = true;
+        else if(policy == sACNMergeLTP && winner != SACN_NO_WINNER && input.ids[winner] == input.lastChanged[address])
+            wins = false;
+        else
+            wins = winner == SACN_NO_WINNER || input.levels[r][address] > level;
+        if(wins)
+        {
+            winner = r;
+            level = input.levels[r][address];
+        }
+    }
+}
+
+#endif // REFERENCE_H
@@ -0,0 +1,10 @@
+# The whole library, for the tests and benchmarks which need the listener, manager or sockets.
+QT += network widgets
+
+SOURCES += \
+    $$files($$SACN_DIR/*.cpp) \
+    $$files($$SACN_DIR/ACNShare/*.cpp)
+
+HEADERS += \
+    $$files($$SACN_DIR/*.h) \
+    $$files($$SACN_DIR/ACNShare/*.h)
@@ -0,0 +1,106 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCESTATEMODEL_H
+#define SOURCESTATEMODEL_H
+
+#include "sacnsourcestate.h"
+#include "streamcommon.h"
+
+/*
+ * A model of the source fields the state machine touches, driven once by
+ * sACNSourceStateMachine::receive(), the branches sACNListener::processPacket() runs, and once
+ * by receiveTable(), which looks the transitions up in the table.
+ */
+
+// The timeouts of sACNListener, with its default hold last look time
+#define MODEL_HLL 1000
+#define MODEL_WAIT_OFFLINE 2500
+#define MODEL_WAIT_PRIORITY 1500
+
+/**
+ * @brief The ModelTimer struct records what was done to a ttimer, its expiry is set by the test
+ */
+struct ModelTimer
+{
+    int interval;
+    bool restarted;
+    bool expired;
+
+    void SetInterval(int ms) { interval = ms; restarted = true; expired = false; }
+    void Reset() { restarted = true; expired = false; }
+    bool Expired() const { return expired; }
+};
+
+/**
+ * @brief The ModelStats struct stands in for sACNSourceStats, recording what it was told
+ */
+struct ModelStats
+{
+    int counted;
+    int deltas;
+
+    void countSequence(int delta) { counted++; deltas += delta; }
+};
+
+/**
+ * @brief The ModelSource struct has the fields of sACNSource the state machine uses
+ */
+struct ModelSource
+{
+    quint8 state;
+    ModelTimer active;
+    ModelTimer priority_wait;
+    int lastseq;
+    int jumps;
+    int seqErr;
+    ModelStats stats;
+
+    void init(quint8 initialState) {
+        state = initialState;
+        active = {0, false, false};
+        priority_wait = {0, false, false};
+        lastseq = jumps = seqErr = 0;
+        stats = {0, 0};
+    }
+    void setState(quint8 newState) { state = newState; }
+};
+
+/**
+ * @brief The ModelPacket struct is what the state machine needs to know about a packet
+ */
+struct ModelPacket
+{
+    int startCode;
+    bool terminated;
+    quint8 sequence;
+};
+
+/**
+ * @brief modelSourceStep runs a packet through sACNSourceStateMachine::receive(), or through
+ * receiveTable() if table is true
+ * @param found false for the first packet of a source
+ */
+template<bool table>
+inline void modelSourceStep(ModelSource &source, bool found, const ModelPacket &packet, bool sampling,
+                            bool &validpacket, bool &newsourcenotify)
+{
+    typedef sACNSourceStateMachine SM;
+    const SM::Timeouts timeouts = {MODEL_WAIT_PRIORITY, MODEL_WAIT_OFFLINE + MODEL_HLL, MODEL_HLL};
+    quint8 input = SM::packetInput(packet.startCode, packet.terminated);
+    quint8 actions = table ? SM::receiveTable(source, found, input, packet.sequence, sampling, timeouts)
+                           : SM::receive(source, found, input, packet.sequence, sampling, timeouts);
+    validpacket = actions & SM::Process;
+    newsourcenotify = actions & SM::Notify;
+}
+
+#endif // SOURCESTATEMODEL_H
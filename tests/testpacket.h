@@ -0,0 +1,37 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TESTPACKET_H
+#define TESTPACKET_H
+
+#include <string.h>
+#include "sacnpacket.h"
+#include "streamcommon.h"
+#include "ACNShare/CID.h"
+
+/**
+ * @brief initTestPacket writes a packet with all 512 addresses of a universe, as sent over unicast
+ * by 127.0.0.1 and received now. Change the levels at packet.data + STREAM_HEADER_SIZE and the
+ * sequence with SetStreamHeaderSequence().
+ */
+inline void initTestPacket(sACNPacket &packet, const CID &source, const char *name, uint1 priority,
+                           uint1 startCode, uint2 universe)
+{
+    memset(packet.data, 0, sizeof(packet.data));
+    InitStreamHeader(packet.data, source, name, priority, 0, 0, startCode, universe, 512);
+    packet.length = STREAM_HEADER_SIZE + 512;
+    packet.sender = 0x7f000001;
+    packet.multicast = false;
+    packet.timestamp = sACNPacket::currentTime();
+}
+
+#endif // TESTPACKET_H
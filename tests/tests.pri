@@ -0,0 +1,11 @@
+# Settings shared by the tests and benchmarks, included by their project files.
+# Tests add CONFIG += testcase so that make check runs them.
+QT = core testlib
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+SACN_DIR = $$PWD/../sacn
+INCLUDEPATH += $$SACN_DIR $$PWD
+
+HEADERS += \
+    $$PWD/testutil.h
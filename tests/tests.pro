@@ -0,0 +1,21 @@
+# Tests and benchmarks of the library, build with qmake && make, run the tests with make check.
+# Benchmarks print their results and are run by hand on an otherwise idle machine.
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    bench_merge \
+    bench_mergepolicies \
+    bench_monitor \
+    bench_receive \
+    bench_sourcestate \
+    bench_workers \
+    tst_allocations \
+    tst_kernels \
+    tst_mergepolicies \
+    tst_samplering \
+    tst_seqlock \
+    tst_sourcestate \
+    tst_sourcestats \
+    tst_sourcetable \
+    tst_timerwheel \
+    tst_tock
@@ -0,0 +1,40 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The TestRandom class is a small xorshift generator, so that tests see the same
+ * sequence on every platform and Qt version
+ */
+class TestRandom
+{
+public:
+    explicit TestRandom(quint32 seed) : m_state(seed ? seed : 1) {}
+
+    quint32 next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+    // A number from 0 to range - 1
+    int bounded(int range) { return int(next() % quint32(range)); }
+
+private:
+    quint32 m_state;
+};
+
+#endif // TESTUTIL_H
@@ -0,0 +1,95 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Feeds a listener steady streams of DMX and per-address priority packets from several sources
+// and counts the heap allocations of processing and merging them. Once every source is known,
+// processing a packet and merging must not allocate.
+
+#include <QtTest>
+#include "sacnlistener.h"
+#include "alloccounter.h"
+#include "testpacket.h"
+
+#define TEST_UNIVERSE 1
+#define TEST_SOURCES 4
+#define TEST_WARMUP_BATCHES 100
+#define TEST_BATCHES 2000
+
+class TestAllocations : public QObject
+{
+    Q_OBJECT
+private slots:
+    void steadyState();
+};
+
+void TestAllocations::steadyState()
+{
+    // Not started, packets are processed as they are routed to the listener
+    sACNListener listener(TEST_UNIVERSE);
+
+    static sACNPacket levels[TEST_SOURCES];
+    static sACNPacket priorities[TEST_SOURCES];
+    for(int s = 0; s < TEST_SOURCES; s++)
+    {
+        CID cid = CID::CreateCid();
+        initTestPacket(levels[s], cid, "Test source", 100, STARTCODE_DMX, TEST_UNIVERSE);
+        initTestPacket(priorities[s], cid, "Test source", 100, STARTCODE_PRIORITY, TEST_UNIVERSE);
+        memset(levels[s].data + STREAM_HEADER_SIZE, 10 * (s + 1), 512);
+        memset(priorities[s].data + STREAM_HEADER_SIZE, 100, 512);
+    }
+
+    quint64 packetAllocations = 0;
+    quint64 mergeAllocations = 0;
+    for(int batch = 0; batch < TEST_WARMUP_BATCHES + TEST_BATCHES; batch++)
+    {
+        bool measure = batch >= TEST_WARMUP_BATCHES;
+        qint64 now = sACNPacket::currentTime();
+        for(int s = 0; s < TEST_SOURCES; s++)
+        {
+            levels[s].timestamp = now;
+            priorities[s].timestamp = now;
+            // Address 0 changes with every packet, the others keep their level
+            levels[s].data[STREAM_HEADER_SIZE] = uint1(batch + s);
+            SetStreamHeaderSequence(levels[s].data, uint1(2 * batch), false);
+            SetStreamHeaderSequence(priorities[s].data, uint1(2 * batch + 1), false);
+        }
+
+        quint64 before = allocationCount();
+        for(int s = 0; s < TEST_SOURCES; s++)
+        {
+            listener.processPacket(levels[s]);
+            listener.processPacket(priorities[s]);
+        }
+        if(measure)
+            packetAllocations += allocationCount() - before;
+
+        // The merge scheduled by the batch, as the receive loops run it
+        before = allocationCount();
+        listener.flushMerge();
+        if(measure)
+            mergeAllocations += allocationCount() - before;
+
+        // Nothing is posted to deliver
+        QCoreApplication::sendPostedEvents();
+    }
+    QCOMPARE(packetAllocations, quint64(0));
+    QCOMPARE(mergeAllocations, quint64(0));
+
+    // The packets were really merged
+    sACNMergedSourceList merged = listener.mergedLevels();
+    for(int a = 1; a < 512; a++)
+        QCOMPARE(merged[a].level, 10 * TEST_SOURCES);
+}
+
+QTEST_GUILESS_MAIN(TestAllocations)
+
+#include "tst_allocations.moc"
@@ -0,0 +1,13 @@
+include(../tests.pri)
+include(../sacn.pri)
+
+TARGET = tst_allocations
+CONFIG += testcase
+
+SOURCES += \
+    tst_allocations.cpp \
+    ../alloccounter.cpp
+
+HEADERS += \
+    ../alloccounter.h \
+    ../testpacket.h
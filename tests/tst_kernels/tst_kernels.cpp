@@ -0,0 +1,109 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks sACNUpdateFrame() and the HTP merge of sACNMerge() against the reference loops on random frames.
+// Build it once per instruction set (e.g. with -mavx2 and without).
+
+#include <QtTest>
+#include "sacnkernels.h"
+#include "reference.h"
+#include "testutil.h"
+
+class TestKernels : public QObject
+{
+    Q_OBJECT
+private slots:
+    void updateFrame();
+    void mergeHTP();
+};
+
+void TestKernels::updateFrame()
+{
+    TestRandom random(1);
+    for(int iteration = 0; iteration < 20000; iteration++)
+    {
+        uint1 frame[512], expected[512], data[600];
+        for(int i = 0; i < 512; i++)
+            frame[i] = expected[i] = uint1(random.bounded(4));
+        for(int i = 0; i < 600; i++)
+            data[i] = uint1(random.bounded(4));
+        int count = random.bounded(600);
+
+        // Bits set before the call must survive it
+        sACNAddressMask changed, expectedChanged;
+        if(random.bounded(2))
+        {
+            changed.set(5);
+            expectedChanged.set(5);
+        }
+
+        bool expectedAny = referenceUpdateFrame(expected, data, count, expectedChanged);
+        bool any = sACNUpdateFrame(frame, data, count, changed);
+        QCOMPARE(any, expectedAny);
+        QVERIFY(memcmp(frame, expected, sizeof(frame)) == 0);
+        QVERIFY(memcmp(changed.bits, expectedChanged.bits, sizeof(changed.bits)) == 0);
+    }
+}
+
+void TestKernels::mergeHTP()
+{
+    static uint1 levels[SACN_MERGE_MAX_ROWS][512];
+    static uint1 priorities[SACN_MERGE_MAX_ROWS][512];
+    static const uint1 tiedPriorities[] = {0, 100, 200, 254, 255};
+    TestRandom random(3);
+    for(int iteration = 0; iteration < 3000; iteration++)
+    {
+        sACNMergeInput input;
+        input.rows = 1 + random.bounded(SACN_MERGE_MAX_ROWS);
+        input.lastChanged = nullptr;
+        for(int r = 0; r < input.rows; r++)
+        {
+            input.levels[r] = levels[r];
+            input.priorities[r] = priorities[r];
+            input.perChannel[r] = random.bounded(2);
+            input.ids[r] = uint1(r);
+            // Few distinct priorities, so that sources tie, including the ones above 200 that
+            // valid sources never send
+            for(int a = 0; a < 512; a++)
+            {
+                levels[r][a] = uint1(random.next());
+                priorities[r][a] = uint1(random.bounded(3) ? tiedPriorities[random.bounded(5)] : random.bounded(256));
+            }
+        }
+
+        sACNAddressMask all;
+        all.setAll();
+        sACNMergeOutput output;
+        sACNMerge(sACNMergeHTP, input, all, output);
+
+        int expectedLevels[512], expectedPriorities[512];
+        referenceMergeHTP(input, expectedLevels, expectedPriorities);
+        for(int a = 0; a < 512; a++)
+        {
+            if(expectedLevels[a] < 0)
+            {
+                QCOMPARE(int(output.winners[a]), SACN_NO_WINNER);
+                continue;
+            }
+            int winner = output.winners[a];
+            QVERIFY(winner < input.rows);
+            QCOMPARE(int(output.levels[a]), expectedLevels[a]);
+            QCOMPARE(int(output.priorities[a]), expectedPriorities[a]);
+            QCOMPARE(levels[winner][a], output.levels[a]);
+            QCOMPARE(priorities[winner][a], output.priorities[a]);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestKernels)
+
+#include "tst_kernels.moc"
@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+TARGET = tst_kernels
+CONFIG += testcase
+
+SOURCES += \
+    tst_kernels.cpp \
+    $$SACN_DIR/sacnkernels.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacnkernels.h \
+    $$SACN_DIR/sacnaddressmask.h
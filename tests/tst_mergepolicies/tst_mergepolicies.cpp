@@ -0,0 +1,97 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks every policy of sACNMerge() against referenceMerge() on random frames, with ties in
+// priority and level, addresses not sent and a partial set of addresses to merge.
+
+#include <QtTest>
+#include "sacnkernels.h"
+#include "reference.h"
+#include "testutil.h"
+
+class TestMergePolicies : public QObject
+{
+    Q_OBJECT
+private slots:
+    void merge_data();
+    void merge();
+};
+
+void TestMergePolicies::merge_data()
+{
+    QTest::addColumn<int>("policy");
+    QTest::newRow("HTP") << int(sACNMergeHTP);
+    QTest::newRow("LTP") << int(sACNMergeLTP);
+    QTest::newRow("MostRecent") << int(sACNMergeMostRecent);
+    QTest::newRow("ForcedSource") << int(sACNMergeForcedSource);
+}
+
+void TestMergePolicies::merge()
+{
+    QFETCH(int, policy);
+
+    static uint1 levels[SACN_MERGE_MAX_ROWS][512];
+    static uint1 priorities[SACN_MERGE_MAX_ROWS][512];
+    static uint1 lastChanged[512];
+    // Ties among all 256 priorities, 255 is the one that beat a forced source
+    static const uint1 tiedPriorities[] = {0, 100, 200, 255};
+    TestRandom random(5 + policy);
+    for(int iteration = 0; iteration < 500; iteration++)
+    {
+        sACNMergeInput input;
+        input.rows = 1 + random.bounded(SACN_MERGE_MAX_ROWS);
+        input.lastChanged = lastChanged;
+        for(int r = 0; r < input.rows; r++)
+        {
+            input.levels[r] = levels[r];
+            input.priorities[r] = priorities[r];
+            input.perChannel[r] = random.bounded(2);
+            input.ids[r] = uint1((r * 7) % SACN_MERGE_MAX_ROWS);
+            for(int a = 0; a < 512; a++)
+            {
+                levels[r][a] = uint1(random.bounded(4) * 60);
+                priorities[r][a] = uint1(random.bounded(3) ? tiedPriorities[random.bounded(4)] : random.bounded(256));
+            }
+        }
+        // Some addresses were last changed by a row which is not merged, or by nobody
+        for(int a = 0; a < 512; a++)
+            lastChanged[a] = uint1(random.bounded(SACN_MERGE_MAX_ROWS + 8));
+
+        sACNAddressMask addresses;
+        if(iteration % 2)
+            addresses.setAll();
+        else
+        {
+            for(int a = 0; a < 512; a++)
+            {
+                if(random.bounded(2))
+                    addresses.set(a);
+            }
+        }
+
+        sACNMergeOutput output;
+        sACNMerge(sACNMergePolicy(policy), input, addresses, output);
+        for(int a = addresses.next(0); a < 512; a = addresses.next(a + 1))
+        {
+            int level, priority, winner;
+            referenceMerge(sACNMergePolicy(policy), input, a, level, priority, winner);
+            QVERIFY2(output.levels[a] == level && output.priorities[a] == priority && output.winners[a] == winner,
+                     qPrintable(QString("%1 rows, address %2: got %3 %4 %5, expected %6 %7 %8").arg(input.rows).arg(a)
+                                .arg(output.levels[a]).arg(output.priorities[a]).arg(output.winners[a])
+                                .arg(level).arg(priority).arg(winner)));
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestMergePolicies)
+
+#include "tst_mergepolicies.moc"
@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+TARGET = tst_mergepolicies
+CONFIG += testcase
+
+SOURCES += \
+    tst_mergepolicies.cpp \
+    $$SACN_DIR/sacnkernels.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacnkernels.h \
+    $$SACN_DIR/sacnaddressmask.h
@@ -0,0 +1,99 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// One thread pushes samples into a small sACNSampleRing as fast as it can while another reads
+// them. The reader must see each sample at most once, in order and intact, and every sample
+// must either be read or counted as lost. Also checks decimate() and minMax().
+
+#include <QtTest>
+#include <thread>
+#include "sacnsamplering.h"
+
+#define TEST_SAMPLES 300000
+
+class TestSampleRing : public QObject
+{
+    Q_OBJECT
+private slots:
+    void concurrent();
+    void reduce();
+};
+
+static void pushSamples(sACNSampleRing *ring)
+{
+    for(qint64 time = 0; time < TEST_SAMPLES; time++)
+        ring->push(time, int(time % 1000));
+}
+
+void TestSampleRing::concurrent()
+{
+    sACNSampleRing ring(256);
+    std::thread writer(pushSamples, &ring);
+
+    sACNSample samples[100];
+    qint64 last = -1;
+    quint64 read = 0;
+    int failures = 0;
+    while(last < TEST_SAMPLES - 1)
+    {
+        int count = ring.read(samples, 100);
+        for(int i = 0; i < count; i++)
+        {
+            if(samples[i].time <= last || samples[i].level != samples[i].time % 1000)
+                failures++;
+            last = samples[i].time;
+        }
+        read += count;
+    }
+    writer.join();
+
+    QCOMPARE(failures, 0);
+    QCOMPARE(read + ring.lost(), quint64(TEST_SAMPLES));
+    QCOMPARE(ring.read(samples, 100), 0);
+}
+
+void TestSampleRing::reduce()
+{
+    sACNSample samples[10];
+    for(int i = 0; i < 10; i++)
+    {
+        samples[i].time = i * 10;
+        samples[i].level = (i * 37) % 11;
+    }
+
+    sACNSample out[10];
+    QCOMPARE(sACNSampleRing::decimate(samples, 10, 3, out), 4);
+    QCOMPARE(out[0].time, qint64(0));
+    QCOMPARE(out[1].time, qint64(30));
+    QCOMPARE(out[2].time, qint64(60));
+    QCOMPARE(out[3].time, qint64(90));
+
+    // Levels 0 4 8 1 5 9 2 6 10 3: the extremes of [0, 50) and [50, 100) in time order
+    QCOMPARE(sACNSampleRing::minMax(samples, 10, 50, out), 4);
+    QCOMPARE(out[0].level, 0);
+    QCOMPARE(out[0].time, qint64(0));
+    QCOMPARE(out[1].level, 8);
+    QCOMPARE(out[1].time, qint64(20));
+    QCOMPARE(out[2].level, 2);
+    QCOMPARE(out[2].time, qint64(60));
+    QCOMPARE(out[3].level, 10);
+    QCOMPARE(out[3].time, qint64(80));
+
+    // In place, with one sample in an interval
+    QCOMPARE(sACNSampleRing::minMax(samples, 10, 5, samples), 10);
+    for(int i = 0; i < 10; i++)
+        QCOMPARE(samples[i].time, qint64(i * 10));
+}
+
+QTEST_APPLESS_MAIN(TestSampleRing)
+
+#include "tst_samplering.moc"
@@ -0,0 +1,11 @@
+include(../tests.pri)
+
+TARGET = tst_samplering
+CONFIG += testcase
+
+SOURCES += \
+    tst_samplering.cpp \
+    $$SACN_DIR/sacnsamplering.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacnsamplering.h
@@ -0,0 +1,113 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// One thread keeps publishing frames through sACNSeqLock while others read them whole and in
+// parts. Every byte of a frame is derived from its number, so a torn read shows.
+
+#include <QtTest>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "sacnseqlock.h"
+
+#define TEST_WRITES 200000
+#define TEST_READERS 3
+
+class TestSeqLock : public QObject
+{
+    Q_OBJECT
+private slots:
+    void concurrentReads();
+};
+
+struct TestFrame
+{
+    quint64 number;
+    quint8 bytes[1500];
+};
+
+static bool consistent(const TestFrame &frame)
+{
+    for(std::size_t i = 0; i < sizeof(frame.bytes); i++)
+    {
+        if(frame.bytes[i] != quint8(frame.number + i))
+            return false;
+    }
+    return true;
+}
+
+static void readFrames(const sACNSeqLock<TestFrame> *lock, const std::atomic<bool> *writing, int reader, int *failures)
+{
+    static TestFrame frames[TEST_READERS];
+    TestFrame &frame = frames[reader];
+    quint64 lastNumber = 0;
+    quint32 lastVersion = 0;
+    while(writing->load())
+    {
+        // Versions and frames never go back, and the version counts the writes, the first
+        // one by the constructor of the lock
+        quint32 version = lock->read(frame);
+        if(!consistent(frame) || frame.number < lastNumber || version < lastVersion || frame.number + 2 != version)
+            ++*failures;
+        lastNumber = frame.number;
+        lastVersion = version;
+
+        // A part starting at a multiple of 8 matches the same frame
+        quint8 part[64];
+        lock->readPart(part, 8 + 512, sizeof(part));
+        quint64 number = part[0] - 512;
+        for(std::size_t i = 1; i < sizeof(part); i++)
+        {
+            if(part[i] != quint8(number + 512 + i))
+                ++*failures;
+        }
+    }
+}
+
+void TestSeqLock::concurrentReads()
+{
+    static sACNSeqLock<TestFrame> lock;
+    static TestFrame frame;
+    // Frame 0 is there before the readers start
+    frame.number = 0;
+    for(std::size_t i = 0; i < sizeof(frame.bytes); i++)
+        frame.bytes[i] = quint8(i);
+    lock.write(frame);
+
+    std::atomic<bool> writing(true);
+    int failures[TEST_READERS] = {};
+    std::vector<std::thread> readers;
+    for(int r = 0; r < TEST_READERS; r++)
+        readers.emplace_back(readFrames, &lock, &writing, r, &failures[r]);
+
+    for(quint64 number = 1; number <= TEST_WRITES; number++)
+    {
+        frame.number = number;
+        for(std::size_t i = 0; i < sizeof(frame.bytes); i++)
+            frame.bytes[i] = quint8(number + i);
+        lock.write(frame);
+    }
+    writing.store(false);
+    for(std::thread &reader : readers)
+        reader.join();
+
+    for(int r = 0; r < TEST_READERS; r++)
+        QCOMPARE(failures[r], 0);
+    TestFrame last;
+    QCOMPARE(lock.read(last), quint32(TEST_WRITES + 2));
+    QCOMPARE(last.number, quint64(TEST_WRITES));
+    QVERIFY(consistent(last));
+}
+
+QTEST_APPLESS_MAIN(TestSeqLock)
+
+#include "tst_seqlock.moc"
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_seqlock
+CONFIG += testcase
+
+SOURCES += \
+    tst_seqlock.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacnseqlock.h
@@ -0,0 +1,82 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs every state, start code, option and timer combination through the branches
+// sACNSourceStateMachine::receive() takes and through its table, and checks that both leave
+// the source alike.
+
+#include <QtTest>
+#include "sourcestatemodel.h"
+
+class TestSourceState : public QObject
+{
+    Q_OBJECT
+private slots:
+    void allCombinations();
+};
+
+static bool sameSource(const ModelSource &branches, const ModelSource &table)
+{
+    return branches.state == table.state
+            && branches.active.interval == table.active.interval
+            && branches.active.restarted == table.active.restarted
+            && branches.priority_wait.interval == table.priority_wait.interval
+            && branches.priority_wait.restarted == table.priority_wait.restarted
+            && branches.lastseq == table.lastseq && branches.jumps == table.jumps
+            && branches.seqErr == table.seqErr
+            && branches.stats.counted == table.stats.counted && branches.stats.deltas == table.stats.deltas;
+}
+
+void TestSourceState::allCombinations()
+{
+    typedef sACNSourceStateMachine SM;
+    const int startCodes[] = {STARTCODE_DMX, STARTCODE_PRIORITY, 0x17};
+    const int priorityWaits[] = {MODEL_WAIT_PRIORITY, MODEL_WAIT_OFFLINE + MODEL_HLL, MODEL_HLL};
+    int cases = 0;
+
+    for(int state = 0; state < SM::StateCount; state++)
+    for(int found = 0; found < 2; found++)
+    for(int startCode : startCodes)
+    for(int terminated = 0; terminated < 2; terminated++)
+    for(int expired = 0; expired < 2; expired++)
+    for(int sampling = 0; sampling < 2; sampling++)
+    for(int sequenceDelta = -25; sequenceDelta <= 3; sequenceDelta++)
+    for(int priorityWait : priorityWaits)
+    {
+        // A new source has no state yet
+        if(!found && state)
+            continue;
+
+        ModelSource branches;
+        branches.init(quint8(state));
+        branches.active = {777, false, false};
+        branches.priority_wait = {priorityWait, false, bool(expired)};
+        branches.lastseq = 100;
+        ModelSource table = branches;
+
+        ModelPacket packet = {startCode, bool(terminated), quint8(100 + sequenceDelta)};
+        bool branchesValid, branchesNotify, tableValid, tableNotify;
+        modelSourceStep<false>(branches, found, packet, sampling, branchesValid, branchesNotify);
+        modelSourceStep<true>(table, found, packet, sampling, tableValid, tableNotify);
+
+        QVERIFY2(sameSource(branches, table) && branchesValid == tableValid && branchesNotify == tableNotify,
+                 qPrintable(QString("state %1 found %2 start code %3 terminated %4 expired %5 sampling %6 "
+                                    "sequence %7 priority wait %8").arg(state).arg(found).arg(startCode)
+                            .arg(terminated).arg(expired).arg(sampling).arg(sequenceDelta).arg(priorityWait)));
+        cases++;
+    }
+    QCOMPARE(cases, 35496);
+}
+
+QTEST_APPLESS_MAIN(TestSourceState)
+
+#include "tst_sourcestate.moc"
@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+TARGET = tst_sourcestate
+CONFIG += testcase
+
+SOURCES += \
+    tst_sourcestate.cpp \
+    $$SACN_DIR/sacnsourcestate.cpp
+
+HEADERS += \
+    ../sourcestatemodel.h \
+    $$SACN_DIR/sacnsourcestate.h
@@ -0,0 +1,99 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Feeds sequences with gaps, late packets, duplicates, wrap-around and restarts to
+// sACNSourceStats the way sACNListener does, and checks the counts, the loss rate and the
+// jitter buckets.
+
+#include <QtTest>
+#include <initializer_list>
+#include "sacnsourcestats.h"
+
+class TestSourceStats : public QObject
+{
+    Q_OBJECT
+private slots:
+    void sequences();
+    void jitter();
+};
+
+/**
+ * @brief countSequences counts the sequence numbers as sACNListener does: the delta is taken
+ * to the highest number received, which only moves on for packets in order or after a restart
+ */
+static sACNSourceStats countSequences(std::initializer_list<int> sequences)
+{
+    sACNSourceStats stats;
+    bool first = true;
+    qint8 last = 0;
+    for(int sequence : sequences)
+    {
+        qint8 delta = first ? 1 : qint8(qint8(sequence) - last);
+        stats.countSequence(delta);
+        if(first || !(delta <= 0 && delta > -20))
+            last = qint8(sequence);
+        first = false;
+    }
+    return stats;
+}
+
+void TestSourceStats::sequences()
+{
+    // Every gap is filled by late packets
+    sACNSourceStats stats = countSequences({1, 2, 3, 5, 6, 4, 7, 7, 10, 9, 8, 11});
+    QCOMPARE(stats.packets, quint64(12));
+    QCOMPARE(stats.lost, quint64(0));
+    QCOMPARE(stats.reordered, quint64(3));
+    QCOMPARE(stats.duplicates, quint64(1));
+    QCOMPARE(stats.lossRate(), 0.0);
+
+    // 4 is lost: 1 of 5 packets, the late 2 counts as received
+    stats = countSequences({1, 3, 2, 5});
+    QCOMPARE(stats.packets, quint64(4));
+    QCOMPARE(stats.lost, quint64(1));
+    QCOMPARE(stats.reordered, quint64(1));
+    QVERIFY(stats.lossRate() > 0.199 && stats.lossRate() < 0.201);
+
+    // Wrapping around is no gap, a jump far back is a restart and counts nothing
+    stats = countSequences({254, 255, 0, 1, 200, 201});
+    QCOMPARE(stats.packets, quint64(6));
+    QCOMPARE(stats.lost, quint64(0));
+    QCOMPARE(stats.reordered, quint64(0));
+    QCOMPARE(stats.duplicates, quint64(0));
+
+    // Duplicates are no loss and do not make the loss rate look better
+    stats = countSequences({1, 1, 1, 3});
+    QCOMPARE(stats.duplicates, quint64(2));
+    QCOMPARE(stats.lost, quint64(1));
+    QVERIFY(stats.lossRate() > 0.332 && stats.lossRate() < 0.334);
+}
+
+void TestSourceStats::jitter()
+{
+    sACNSourceStats stats;
+    // ns: below 1us, 1us, 2us, 4us and way above the last bucket, both ways
+    for(qint64 variation : {0LL, 500LL, 1024LL, 3000LL, -3000LL, 4096LL, 20000000LL, -20000000LL})
+        stats.countJitter(variation);
+    QCOMPARE(stats.jitter[0], quint64(2));
+    QCOMPARE(stats.jitter[1], quint64(1));
+    QCOMPARE(stats.jitter[2], quint64(2));
+    QCOMPARE(stats.jitter[3], quint64(1));
+    QCOMPARE(stats.jitter[sACNSourceStats::JitterBuckets - 1], quint64(2));
+    quint64 total = 0;
+    for(int bucket = 0; bucket < sACNSourceStats::JitterBuckets; bucket++)
+        total += stats.jitter[bucket];
+    QCOMPARE(total, quint64(8));
+}
+
+QTEST_APPLESS_MAIN(TestSourceStats)
+
+#include "tst_sourcestats.moc"
@@ -0,0 +1,11 @@
+include(../tests.pri)
+
+TARGET = tst_sourcestats
+CONFIG += testcase
+
+SOURCES += \
+    tst_sourcestats.cpp \
+    $$SACN_DIR/sacnsourcestats.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacnsourcestats.h
@@ -0,0 +1,142 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Inserts, removes and finds CIDs in sACNSourceTable at random, next to a QHash of the same CIDs.
+// Half of the CIDs are picked to share a few home entries, so that long probe runs form and
+// removals shift entries back. In every other run those entries are the last and first of the
+// table, so the runs wrap past its end. Every CID must be found exactly where the QHash has it.
+
+#include <QtTest>
+#include <string.h>
+#include "sacnsourcetable.h"
+#include "testutil.h"
+
+#define TEST_RUNS 100
+#define TEST_STEPS 2000
+#define TEST_CIDS 96
+// Up to 48 CIDs at a time, so the table grows to 128 entries
+#define TEST_MAX_COUNT 48
+#define TEST_HOME_MASK 127
+// The number of neighbouring home entries shared by the colliding CIDs
+#define TEST_CLUSTER 4
+
+class TestSourceTable : public QObject
+{
+    Q_OBJECT
+private slots:
+    void randomOperations_data();
+    void randomOperations();
+private:
+    static CID randomCid(TestRandom &random);
+    static quint32 hash(const CID &cid) { return sACNSourceTable::hash(sACNSourceTable::makeKey(cid)); }
+    // Whether an entry is not at its home, and whether a probe run covers the end of the table
+    static bool displaced(const sACNSourceTable &table);
+    static bool wraps(const sACNSourceTable &table);
+};
+
+CID TestSourceTable::randomCid(TestRandom &random)
+{
+    uint1 buffer[CID::CIDBYTES];
+    for(int i = 0; i < CID::CIDBYTES; i += sizeof(quint32))
+    {
+        quint32 bits = random.next();
+        memcpy(buffer + i, &bits, sizeof(bits));
+    }
+    return CID(buffer);
+}
+
+bool TestSourceTable::displaced(const sACNSourceTable &table)
+{
+    for(size_t i = 0; i < table.m_entries.size(); i++)
+    {
+        const sACNSourceTable::Entry &entry = table.m_entries[i];
+        if(entry.slot >= 0 && (sACNSourceTable::hash(entry.key) & table.m_mask) != i)
+            return true;
+    }
+    return false;
+}
+
+bool TestSourceTable::wraps(const sACNSourceTable &table)
+{
+    return table.m_entries.front().slot >= 0 && table.m_entries.back().slot >= 0;
+}
+
+void TestSourceTable::randomOperations_data()
+{
+    QTest::addColumn<int>("run");
+    for(int run = 0; run < TEST_RUNS; run++)
+        QTest::newRow(qPrintable(QString("run %1").arg(run))) << run;
+}
+
+void TestSourceTable::randomOperations()
+{
+    QFETCH(int, run);
+
+    TestRandom random(quint32(run + 1));
+    // The colliding CIDs have their homes from first on, the low bits of the hash select the
+    // home at every size of the table
+    bool wrapAround = run % 2 == 0;
+    quint32 first = wrapAround ? TEST_HOME_MASK + 1 - TEST_CLUSTER / 2 : quint32(random.bounded(TEST_HOME_MASK - TEST_CLUSTER));
+    CID cids[TEST_CIDS];
+    for(int i = 0; i < TEST_CIDS / 2;)
+    {
+        cids[i] = randomCid(random);
+        if(((hash(cids[i]) - first) & TEST_HOME_MASK) < TEST_CLUSTER)
+            i++;
+    }
+    for(int i = TEST_CIDS / 2; i < TEST_CIDS; i++)
+        cids[i] = randomCid(random);
+
+    sACNSourceTable table;
+    QHash<CID, int> reference;
+    bool collided = false;
+    bool wrapped = false;
+    for(int step = 0; step < TEST_STEPS; step++)
+    {
+        const CID &cid = cids[random.bounded(TEST_CIDS)];
+        int operation = random.bounded(10);
+        if(operation < 5)
+        {
+            if(!reference.contains(cid) && reference.size() < TEST_MAX_COUNT)
+            {
+                int slot = random.bounded(TEST_MAX_COUNT);
+                table.insert(cid, slot);
+                reference.insert(cid, slot);
+            }
+        }
+        else if(operation < 8)
+        {
+            table.remove(cid);
+            reference.remove(cid);
+        }
+        QCOMPARE(table.count(), reference.size());
+        collided = collided || displaced(table);
+        wrapped = wrapped || wraps(table);
+
+        // Every CID, in the table or not
+        for(int i = 0; i < TEST_CIDS; i++)
+        {
+            int found = table.find(cids[i]);
+            int expected = reference.value(cids[i], -1);
+            QVERIFY2(found == expected,
+                     qPrintable(QString("Step %1: CID %2 found in slot %3 instead of %4").arg(step).arg(i).arg(found).arg(expected)));
+        }
+    }
+
+    QVERIFY2(collided, "No CID was moved away from its home entry");
+    if(wrapAround)
+        QVERIFY2(wrapped, "No probe run wrapped past the end of the table");
+}
+
+QTEST_APPLESS_MAIN(TestSourceTable)
+
+#include "tst_sourcetable.moc"
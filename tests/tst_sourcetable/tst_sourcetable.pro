@@ -0,0 +1,13 @@
+include(../tests.pri)
+
+TARGET = tst_sourcetable
+CONFIG += testcase
+
+SOURCES += \
+    tst_sourcetable.cpp \
+    $$SACN_DIR/sacnsourcetable.cpp \
+    $$SACN_DIR/ACNShare/CID.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacnsourcetable.h \
+    $$SACN_DIR/ACNShare/CID.h
@@ -0,0 +1,115 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Schedules, cancels and advances sACNTimerWheel at random, next to a plain list of deadlines.
+// Deadlines range from the past to hours ahead, and some runs start just before the tock wraps.
+// advance() must expire exactly the ids which are due, and nextTick() must never be later than
+// the next deadline.
+
+#include <QtTest>
+#include <set>
+#include "sacntimerwheel.h"
+#include "testutil.h"
+
+#define TEST_IDS 64
+#define TEST_RUNS 200
+#define TEST_STEPS 20000
+
+class TestTimerWheel : public QObject
+{
+    Q_OBJECT
+private slots:
+    void randomOperations_data();
+    void randomOperations();
+};
+
+void TestTimerWheel::randomOperations_data()
+{
+    QTest::addColumn<int>("run");
+    for(int run = 0; run < TEST_RUNS; run++)
+        QTest::newRow(qPrintable(QString("run %1").arg(run))) << run;
+}
+
+void TestTimerWheel::randomOperations()
+{
+    QFETCH(int, run);
+
+    TestRandom random(quint32(run + 1));
+    quint32 now = run % 3 == 0 ? 0xffff0000u + random.next() % 0x10000 : random.next();
+    sACNTimerWheel wheel(TEST_IDS, now);
+    bool scheduled[TEST_IDS] = {};
+    quint32 deadlines[TEST_IDS];
+
+    for(int step = 0; step < TEST_STEPS; step++)
+    {
+        int operation = random.bounded(10);
+        if(operation < 6)
+        {
+            const int spans[] = {100, 3000, 400000, 30000000};
+            int id = random.bounded(TEST_IDS);
+            quint32 deadline = now + quint32(random.bounded(spans[random.bounded(4)]));
+            if(random.bounded(5) == 0)
+                deadline -= 10;
+            wheel.schedule(id, deadline);
+            scheduled[id] = true;
+            deadlines[id] = deadline;
+        }
+        else if(operation < 7)
+        {
+            int id = random.bounded(TEST_IDS);
+            wheel.cancel(id);
+            scheduled[id] = false;
+        }
+        else
+        {
+            int next = -1;
+            for(int id = 0; id < TEST_IDS; id++)
+            {
+                if(!scheduled[id])
+                    continue;
+                int remaining = qMax(0, int(qint32(deadlines[id] - now)));
+                if(next < 0 || remaining < next)
+                    next = remaining;
+            }
+            int tick = wheel.nextTick(now);
+            QCOMPARE(tick < 0, next < 0);
+            QVERIFY(tick <= next);
+
+            // Sometimes right to the next deadline, otherwise a short or a long way
+            if(random.bounded(3) == 0 && next >= 0)
+                now += quint32(next);
+            else
+                now += quint32(random.bounded(random.bounded(2) ? 50 : 100000));
+
+            int expired[TEST_IDS];
+            int count = wheel.advance(now, expired);
+            std::set<int> got(expired, expired + count);
+            std::set<int> expected;
+            for(int id = 0; id < TEST_IDS; id++)
+            {
+                if(scheduled[id] && qint32(deadlines[id] - now) <= 0)
+                {
+                    expected.insert(id);
+                    scheduled[id] = false;
+                }
+            }
+            QCOMPARE(int(got.size()), count);
+            QVERIFY(got == expected);
+            for(int id = 0; id < TEST_IDS; id++)
+                QCOMPARE(wheel.isScheduled(id), scheduled[id]);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestTimerWheel)
+
+#include "tst_timerwheel.moc"
@@ -0,0 +1,11 @@
+include(../tests.pri)
+
+TARGET = tst_timerwheel
+CONFIG += testcase
+
+SOURCES += \
+    tst_timerwheel.cpp \
+    $$SACN_DIR/sacntimerwheel.cpp
+
+HEADERS += \
+    $$SACN_DIR/sacntimerwheel.h
@@ -0,0 +1,92 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks that a TockCacheScope freezes Tock_GetTock() and the ttimers of its thread, and only
+// of its thread, until the outermost scope ends.
+
+#include <QtTest>
+#include <chrono>
+#include <thread>
+#include "ACNShare/deftypes.h"
+#include "ACNShare/tock.h"
+
+// Longer than the tick of CLOCK_MONOTONIC_COARSE
+#define TEST_SLEEP_MS 20
+
+class TestTock : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void uncached();
+    void cacheScope();
+};
+
+static void sleepTestTime()
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_SLEEP_MS));
+}
+
+static void readTock(uint4 *ms)
+{
+    *ms = Tock_GetTock().Getms();
+}
+
+void TestTock::initTestCase()
+{
+    Tock_StartLib();
+}
+
+void TestTock::uncached()
+{
+    // Without a scope every read sees the clock
+    uint4 start = Tock_GetTock().Getms();
+    sleepTestTime();
+    QVERIFY(Tock_GetTock().Getms() - start >= TEST_SLEEP_MS - 5);
+}
+
+void TestTock::cacheScope()
+{
+    uint4 cached;
+    ttimer timer;
+    {
+        TockCacheScope scope;
+        cached = Tock_GetTock().Getms();
+        timer.SetInterval(TEST_SLEEP_MS / 2);
+        sleepTestTime();
+        QCOMPARE(Tock_GetTock().Getms(), cached);
+        QVERIFY(!timer.Expired());
+        QCOMPARE(timer.Remaining(), TEST_SLEEP_MS / 2 + 1);
+
+        {
+            // A nested scope keeps the time of the outer one
+            TockCacheScope inner;
+            QCOMPARE(Tock_GetTock().Getms(), cached);
+        }
+        QCOMPARE(Tock_GetTock().Getms(), cached);
+
+        // Other threads still read the clock
+        uint4 other = 0;
+        std::thread thread(readTock, &other);
+        thread.join();
+        QVERIFY(other - cached >= TEST_SLEEP_MS - 5);
+    }
+
+    // The time moves on once the outermost scope is gone
+    QVERIFY(Tock_GetTock().Getms() - cached >= TEST_SLEEP_MS - 5);
+    QVERIFY(timer.Expired());
+    QCOMPARE(timer.Remaining(), 0);
+}
+
+QTEST_APPLESS_MAIN(TestTock)
+
+#include "tst_tock.moc"
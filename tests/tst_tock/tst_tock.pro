@@ -0,0 +1,13 @@
+include(../tests.pri)
+
+TARGET = tst_tock
+CONFIG += testcase
+
+# Run it with either clock, the default one and DEFINES += TOCK_MONOTONIC_COARSE on Linux
+SOURCES += \
+    tst_tock.cpp \
+    $$SACN_DIR/ACNShare/tock.cpp
+
+HEADERS += \
+    $$SACN_DIR/ACNShare/deftypes.h \
+    $$SACN_DIR/ACNShare/tock.h